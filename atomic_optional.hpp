@@ -0,0 +1,106 @@
+// Copyright (C) 2014 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_STORAGE_ATOMIC_OPTIONAL_HPP_INCLUDED
+#define FOONATHAN_STORAGE_ATOMIC_OPTIONAL_HPP_INCLUDED
+
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+#include "optional.hpp"
+#include "raw_storage.hpp"
+
+namespace foonathan { namespace storage
+{
+    /// \brief An optional value published from one writer to many readers without a lock.
+    /// \detail It layers a seqlock over the \ref storage buffer:
+    /// the writer bumps a sequence counter to an odd value, stores the bytes
+    /// and bumps it to the next even value; readers copy the bytes and retry
+    /// if the counter changed in between, so a torn read is never observed.
+    /// Reads are wait-free as long as the writer is not currently storing.
+    /// \note Only trivially copyable types can be stored
+    /// and there must never be more than one thread writing.
+    template <typename T>
+    class atomic_optional
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "seqlock publication requires a trivially copyable type");
+    public:
+        //=== typedefs ===//
+        using value_type = T;
+
+        //=== constructors ===//
+        /// \brief Creates an empty atomic optional.
+        atomic_optional() noexcept
+        : present_(false), sequence_(0u) {}
+
+        /// \brief Creates an atomic optional holding a value.
+        atomic_optional(const value_type &val) noexcept
+        : present_(true), sequence_(0u)
+        {
+            emplace<value_type>(storage_, val);
+        }
+
+        atomic_optional(const atomic_optional &) = delete;
+        atomic_optional& operator=(const atomic_optional &) = delete;
+
+        //=== writer interface ===//
+        /// \brief Publishes a new value.
+        /// \note Must only be called from the single writer thread.
+        void store(const value_type &val) noexcept
+        {
+            auto seq = sequence_.load(std::memory_order_relaxed);
+            // odd sequence marks a store in progress
+            sequence_.store(seq + 1u, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            emplace<value_type>(storage_, val);
+            present_ = true;
+            sequence_.store(seq + 2u, std::memory_order_release);
+        }
+
+        /// \brief Publishes the empty state.
+        /// \note Must only be called from the single writer thread.
+        void reset() noexcept
+        {
+            auto seq = sequence_.load(std::memory_order_relaxed);
+            sequence_.store(seq + 1u, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            present_ = false;
+            sequence_.store(seq + 2u, std::memory_order_release);
+        }
+
+        //=== reader interface ===//
+        /// \brief Returns a snapshot of the current state.
+        /// \detail Retries while the writer is storing or the bytes were torn,
+        /// it never returns a half-written value.
+        /// Safe to call from any number of reader threads.
+        optional<value_type> load() const noexcept
+        {
+            while (true)
+            {
+                auto begin = sequence_.load(std::memory_order_acquire);
+                if (begin & 1u)
+                    continue; // store in progress
+
+                // copy out the protected bytes
+                storage<value_type> copy;
+                std::memcpy(&copy, &storage_, sizeof(copy));
+                auto present = present_;
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (sequence_.load(std::memory_order_relaxed) == begin)
+                    return present ? optional<value_type>(*get<value_type>(copy))
+                                   : optional<value_type>(nullopt);
+            }
+        }
+
+    private:
+        storage<value_type> storage_;
+        bool present_;
+        std::atomic<unsigned> sequence_;
+    };
+}} // namespace foonathan::storage
+
+#endif // FOONATHAN_STORAGE_ATOMIC_OPTIONAL_HPP_INCLUDED
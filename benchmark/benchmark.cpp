@@ -0,0 +1,177 @@
+// Copyright (C) 2014 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+// Micro benchmarks for the hot paths of variant and optional:
+// visit dispatch, same-type vs. cross-type emplace, optional swap/copy and hashing.
+// Self-contained, only needs <chrono>; compile with optimizations, e.g.
+//   g++ -std=c++11 -O2 -I.. benchmark.cpp
+// Where the standard library provides a counterpart (std::optional since C++17),
+// the same loop is run against it for a baseline number.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "../storage.hpp"
+
+#if __cplusplus >= 201703L
+    #include <optional>
+#endif
+
+// namespace alias
+namespace storage = foonathan::storage;
+
+namespace
+{
+    // keeps a result alive so the compiler cannot drop the measured loop
+    volatile std::size_t sink = 0u;
+
+    // runs f() iterations times and prints the average time per iteration
+    template <class F>
+    void run(const char *name, std::size_t iterations, F f)
+    {
+        using clock = std::chrono::steady_clock;
+        // warm up caches and branch predictors
+        for (auto i = 0u; i != 100u; ++i)
+            f();
+        auto begin = clock::now();
+        for (std::size_t i = 0u; i != iterations; ++i)
+            f();
+        auto end = clock::now();
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+        std::printf("%-32s %8.2f ns/iter\n", name,
+                    double(ns) / double(iterations));
+    }
+
+    constexpr std::size_t iterations = 1000000u;
+
+    // a visitor summing whatever it sees
+    struct sum_visitor
+    {
+        std::size_t operator()(int i) const noexcept
+        {
+            return std::size_t(i);
+        }
+
+        std::size_t operator()(float f) const noexcept
+        {
+            return std::size_t(f);
+        }
+
+        std::size_t operator()(const std::string &str) const noexcept
+        {
+            return str.size();
+        }
+    };
+} // namespace
+
+int main()
+{
+    using variant = storage::variant<int, float, std::string>;
+
+    //=== visit dispatch ===//
+    {
+        // mixed actives so the dispatch cannot be predicted away entirely
+        std::vector<variant> variants;
+        for (auto i = 0; i != 64; ++i)
+            variants.push_back(i % 3 == 0 ? variant(i)
+                             : i % 3 == 1 ? variant(float(i))
+                             : variant(std::string("str")));
+        run("variant/visit", iterations, [&]
+            {
+                auto sum = std::size_t(0);
+                for (auto &var : variants)
+                    sum += visit(var, sum_visitor());
+                sink = sum;
+            });
+    }
+
+    //=== emplace ===//
+    {
+        variant var(0);
+        run("variant/emplace same-type", iterations, [&]
+            {
+                storage::emplace<int>(var, 42);
+                sink = std::size_t(storage::get<int>(var));
+            });
+        run("variant/emplace cross-type", iterations, [&]
+            {
+                storage::emplace<float>(var, 1.f);
+                storage::emplace<int>(var, 42);
+                sink = std::size_t(storage::get<int>(var));
+            });
+    }
+
+    //=== hashing ===//
+    {
+        const variant var(42);
+        std::hash<variant> hasher;
+        run("variant/hash", iterations, [&]
+            {
+                sink = hasher(var);
+            });
+    }
+
+    //=== optional ===//
+    {
+        storage::optional<int> a(1), b(2);
+        run("optional/swap", iterations, [&]
+            {
+                swap(a, b);
+                sink = std::size_t(storage::get(a));
+            });
+        run("optional/copy", iterations, [&]
+            {
+                storage::optional<int> copy(a);
+                sink = std::size_t(storage::get(copy));
+            });
+
+        const storage::optional<int> opt(42);
+        std::hash<storage::optional<int>> hasher;
+        run("optional/hash", iterations, [&]
+            {
+                sink = hasher(opt);
+            });
+
+        // a monadic pipeline against the equivalent hand-written checks,
+        // both should collapse into the same straight-line code
+        run("optional/monadic chain", iterations, [&]
+            {
+                auto result = try_get(
+                    or_else(map(and_then(map(opt, [](int i) { return i + 1; }),
+                                         [](int i) { return storage::optional<int>(i * 2); }),
+                                [](int i) { return i - 3; }),
+                            [] { return storage::optional<int>(0); }),
+                    0);
+                sink = std::size_t(result);
+            });
+        run("optional/manual chain", iterations, [&]
+            {
+                auto result = 0;
+                if (opt)
+                    result = (*opt + 1) * 2 - 3;
+                sink = std::size_t(result);
+            });
+    }
+
+#if __cplusplus >= 201703L
+    //=== std::optional baseline ===//
+    {
+        std::optional<int> a(1), b(2);
+        run("std::optional/swap", iterations, [&]
+            {
+                swap(a, b);
+                sink = std::size_t(*a);
+            });
+        run("std::optional/copy", iterations, [&]
+            {
+                std::optional<int> copy(a);
+                sink = std::size_t(*copy);
+            });
+    }
+#endif
+}
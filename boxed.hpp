@@ -0,0 +1,252 @@
+// Copyright (C) 2014 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_STORAGE_BOXED_HPP_INCLUDED
+#define FOONATHAN_STORAGE_BOXED_HPP_INCLUDED
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "padded.hpp"
+#include "raw_storage.hpp"
+
+namespace foonathan { namespace storage
+{
+    /// \brief The default pool policy for \ref boxed, it allocates each object on the heap.
+    /// \detail A pool policy provides stateless, static \c allocate()/deallocate() functions
+    /// returning memory suitable for one \c T.
+    template <typename T>
+    struct heap_pool
+    {
+        static void* allocate()
+        {
+            return ::operator new(sizeof(T));
+        }
+
+        static void deallocate(void *memory) noexcept
+        {
+            ::operator delete(memory);
+        }
+    };
+
+    /// \brief A fixed-size pool policy for \ref boxed that never touches the heap.
+    /// \detail It hands out slots from a static block of \c N nodes via an intrusive free list,
+    /// so allocation and deallocation are O(1) pointer operations.
+    /// All \ref boxed objects instantiated with the same policy share the pool.
+    /// \note It is not thread-safe and asserts when exhausted.
+    template <typename T, std::size_t N>
+    class fixed_pool
+    {
+        static_assert(N > 0u, "need at least one slot");
+    public:
+        static void* allocate()
+        {
+            auto &p = pool();
+            assert(p.head && "pool exhausted");
+            auto node = p.head;
+            p.head = node->next;
+            return node;
+        }
+
+        static void deallocate(void *memory) noexcept
+        {
+            auto &p = pool();
+            auto node = static_cast<node_t*>(memory);
+            node->next = p.head;
+            p.head = node;
+        }
+
+    private:
+        union node_t
+        {
+            node_t *next;
+            storage<T> object;
+        };
+
+        struct pool_t
+        {
+            node_t nodes[N];
+            node_t *head;
+
+            pool_t() noexcept
+            : head(nodes)
+            {
+                for (std::size_t i = 0u; i != N - 1u; ++i)
+                    nodes[i].next = &nodes[i + 1u];
+                nodes[N - 1u].next = nullptr;
+            }
+        };
+
+        static pool_t& pool() noexcept
+        {
+            static pool_t p;
+            return p;
+        }
+    };
+
+    /// \brief Stores an object out-of-line in a pool, staying the size of one pointer itself.
+    /// \detail Use it for an oversized alternative in a \ref variant:
+    /// \ref storage is sized to the largest type,
+    /// so boxing a rare 2KB message keeps every other instance small and cache dense.
+    /// It implicitly converts to references of the stored type,
+    /// so a visitor overload taking the underlying type accepts the boxed alternative unchanged.<br>
+    /// The pool policy is stateless (see \ref heap_pool and \ref fixed_pool),
+    /// allocation happens on construction, deallocation on destruction.
+    /// \note A moved-from boxed object is empty, it may only be destroyed or assigned to.
+    template <typename T, class Pool = heap_pool<T>>
+    class boxed
+    {
+        static_assert(!std::is_reference<T>::value, "can't store references");
+    public:
+        //=== typedefs ===//
+        using value_type = T;
+        using pool = Pool;
+
+        //=== constructors/destructor/assignment ===//
+        /// \brief Allocates a slot from the pool and constructs the value inside it.
+        template <typename ... Args,
+                  typename = typename std::enable_if<
+                      !std::is_same<typename std::decay<typename detail::first_of<Args...>::type>::type,
+                                    boxed>::value>::type>
+        boxed(Args&&... args)
+        {
+            auto memory = Pool::allocate();
+            try
+            {
+                ptr_ = ::new(memory) value_type(std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                Pool::deallocate(memory);
+                throw;
+            }
+        }
+
+        /// \brief Copy-constructs by copying the stored value into a new slot.
+        boxed(const boxed &other)
+        : boxed(other.value()) {}
+
+        /// \brief Move-constructs by stealing the slot, no value is moved.
+        boxed(boxed &&other) noexcept
+        : ptr_(other.ptr_)
+        {
+            other.ptr_ = nullptr;
+        }
+
+        /// \brief Destroys the value and returns the slot to the pool.
+        ~boxed() noexcept
+        {
+            if (ptr_)
+            {
+                ptr_->~value_type();
+                Pool::deallocate(ptr_);
+            }
+        }
+
+        /// @{
+        /// \brief Assigns another boxed object, the copy goes through a new slot.
+        boxed& operator=(const boxed &other)
+        {
+            boxed tmp(other);
+            swap(*this, tmp);
+            return *this;
+        }
+
+        boxed& operator=(boxed &&other) noexcept
+        {
+            swap(*this, other);
+            return *this;
+        }
+        /// @}
+
+        /// \brief Assigns a new value in place.
+        template <typename U>
+        boxed& operator=(U &&u)
+        {
+            value() = std::forward<U>(u);
+            return *this;
+        }
+
+        /// \brief Swaps two boxed objects by swapping the slots.
+        friend void swap(boxed &a, boxed &b) noexcept
+        {
+            std::swap(a.ptr_, b.ptr_);
+        }
+
+        //=== accessors ===//
+        /// @{
+        /// \brief Returns a reference to the stored value.
+        value_type& value() noexcept
+        {
+            assert(ptr_ && "boxed object is empty");
+            return *ptr_;
+        }
+
+        const value_type& value() const noexcept
+        {
+            assert(ptr_ && "boxed object is empty");
+            return *ptr_;
+        }
+        /// @}
+
+        /// @{
+        /// \brief Implicitly dereferences to the stored value.
+        operator value_type&() noexcept
+        {
+            return value();
+        }
+
+        operator const value_type&() const noexcept
+        {
+            return value();
+        }
+        /// @}
+
+        //=== comparision ===//
+        /// @{
+        /// \brief Compares the stored values.
+        friend bool operator==(const boxed &a, const boxed &b)
+        {
+            return a.value() == b.value();
+        }
+
+        friend bool operator!=(const boxed &a, const boxed &b)
+        {
+            return !(a == b);
+        }
+
+        friend bool operator==(const boxed &a, const value_type &b)
+        {
+            return a.value() == b;
+        }
+
+        friend bool operator==(const value_type &a, const boxed &b)
+        {
+            return b == a;
+        }
+
+        friend bool operator!=(const boxed &a, const value_type &b)
+        {
+            return !(a == b);
+        }
+
+        friend bool operator!=(const value_type &a, const boxed &b)
+        {
+            return !(b == a);
+        }
+        /// @}
+
+    private:
+        value_type *ptr_;
+    };
+
+    /// \brief A \ref boxed object is trivially relocatable, moving it just moves the pointer.
+    /// \detail This keeps a \ref variant with a boxed alternative on the cheap relocation paths.
+    template <typename T, class Pool>
+    struct is_trivially_relocatable<boxed<T, Pool>> : std::true_type {};
+}} // namespace foonathan::storage
+
+#endif // FOONATHAN_STORAGE_BOXED_HPP_INCLUDED
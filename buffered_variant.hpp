@@ -0,0 +1,319 @@
+// Copyright (C) 2014 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_STORAGE_BUFFERED_VARIANT_HPP_INCLUDED
+#define FOONATHAN_STORAGE_BUFFERED_VARIANT_HPP_INCLUDED
+
+#include <cassert>
+#include <type_traits>
+
+#include "variant.hpp"
+
+namespace foonathan { namespace storage
+{
+    /// \brief A \ref variant trading storage for cheap strong exception safety.
+    /// \detail When \ref variant changes the active type and the constructor can throw,
+    /// it has to construct a temporary and move it into storage.
+    /// This class instead holds two storage slots and constructs the new value
+    /// directly into the inactive one, flipping the active slot on success:
+    /// strong exception safety without any temporary, at the cost of twice the storage.<br>
+    /// It provides the same core interface as \ref variant.
+    template <typename ... Types>
+    class buffered_variant
+    {
+        static_assert(detail::valid_types<Types...>(), "can't store references");
+        using nothrow_move = std::integral_constant<bool, detail::nothrow_move_types<Types...>()>;
+        using which_type = detail::compact_index_t<sizeof...(Types)>;
+    public:
+        //=== statics ===//
+        /// \brief Represents an invalid index of a type.
+        static constexpr auto invalid_index = sizeof...(Types);
+
+        /// \brief The types.
+        using types = variant_types<Types...>;
+
+        //=== constructors/destructor/assignment ===//
+        /// @{
+        /// \brief Creates a null variant.
+        buffered_variant() noexcept
+        : active_(0u), which_(which_type(invalid_index)) {}
+
+        buffered_variant(nullvar_t) noexcept
+        : buffered_variant() {}
+        /// @}
+
+        /// \brief Initializes a variant with a value.
+        /// \note The type must be one of the types specified.
+        template <typename T>
+        buffered_variant(T &&val)
+        : buffered_variant()
+        {
+            using t = typename std::decay<T>::type;
+            constexpr auto index = detail::get_index<t, Types...>();
+            static_assert(index != invalid_index,
+                          "type is not one of the types specified");
+            emplace<t>(storage_[0u], std::forward<T>(val));
+            which_ = which_type(index);
+        }
+
+        /// \brief Copy-constructs a variant by copying the currently stored type.
+        buffered_variant(const buffered_variant &other)
+        : buffered_variant()
+        {
+            visit(other, detail::variant_emplace_visitor(*this));
+        }
+
+        /// \brief Move-constructs a variant by moving the currently stored type.
+        /// \detail The other variant still contains a value of that type after the operation,
+        /// but a value that has been moved out.
+        buffered_variant(buffered_variant &&other) noexcept(nothrow_move::value)
+        : buffered_variant()
+        {
+            visit(std::move(other), detail::variant_emplace_visitor(*this));
+        }
+
+        /// \brief Destroys the currently stored value - if any.
+        ~buffered_variant() noexcept
+        {
+            *this = nullvar;
+        }
+
+        /// @{
+        /// \brief Assigns another variant by copying/moving the currently stored value.
+        /// \detail It just calls \ref emplace() passing the currently stored type,
+        /// so a throwing constructor leaves the old value untouched.
+        buffered_variant& operator=(const buffered_variant &other)
+        {
+            if (!other)
+                *this = nullvar;
+            else
+                visit(other, detail::variant_emplace_visitor(*this));
+            return *this;
+        }
+
+        buffered_variant& operator=(buffered_variant &&other) noexcept(nothrow_move::value)
+        {
+            if (!other)
+                *this = nullvar;
+            else
+                visit(std::move(other), detail::variant_emplace_visitor(*this));
+            return *this;
+        }
+        /// @}
+
+        /// \brief Assigns a null state to the variant and destroys the formerly stored value.
+        buffered_variant& operator=(nullvar_t) noexcept
+        {
+            if (*this)
+                visit(*this, detail::variant_destroy_visitor());
+            which_ = which_type(invalid_index);
+            return *this;
+        }
+
+        /// \brief Assigns a new value.
+        /// \note The type must be one of the types specified.
+        template <typename T>
+        buffered_variant& operator=(T &&val)
+        {
+            using t = typename std::decay<T>::type;
+            emplace<t>(*this, std::forward<T>(val));
+            return *this;
+        }
+
+        //=== accessors ===//
+        /// \brief Returns \c true if there is an object currently stored inside the variant.
+        explicit operator bool() const noexcept
+        {
+            return which_ != invalid_index;
+        }
+
+        /// \brief Returns the index of the type of the currently stored inside the variant.
+        /// \detail If the variant is not vaild, it returns \ref invalid_index.
+        std::size_t which() const noexcept
+        {
+            return which_;
+        }
+
+        //=== comparision ===//
+        /// @{
+        /// \brief Compares two variants for (in-)equality.
+        /// \detail They are equal, if either both are invalid or store the same object.
+        friend bool operator==(const buffered_variant &a, const buffered_variant &b)
+        {
+            if (!a && !b)
+                return true;
+            if (a.which() == b.which())
+                return visit(b, detail::variant_compare_visitor<buffered_variant>(a));
+            return false;
+        }
+
+        friend bool operator!=(const buffered_variant &a, const buffered_variant &b)
+        {
+            return !(a == b);
+        }
+        /// @}
+
+        /// @{
+        /// \brief Compares a variant and \ref nullvar_t.
+        friend bool operator==(const buffered_variant &a, nullvar_t) noexcept
+        {
+            return !a;
+        }
+
+        friend bool operator==(nullvar_t, const buffered_variant &b) noexcept
+        {
+            return !b;
+        }
+
+        friend bool operator!=(const buffered_variant &a, nullvar_t) noexcept
+        {
+            return static_cast<bool>(a);
+        }
+
+        friend bool operator!=(nullvar_t, const buffered_variant &b) noexcept
+        {
+            return static_cast<bool>(b);
+        }
+        /// @}
+
+    private:
+        // single argument that can be assigned
+        template <typename T, typename U>
+        void assign(U &&u,
+                    decltype(std::declval<T&>() = std::forward<U>(u), int()) = 0)
+        {
+            get<T>(*this) = std::forward<U>(u);
+        }
+
+        // multiple arguments or single one that can't be assigned directly
+        template <typename T, typename ... Args>
+        void assign(Args&&... args)
+        {
+            get<T>(*this) = T(std::forward<Args>(args)...);
+        }
+
+        storage<Types...> storage_[2];
+        unsigned char active_;
+        which_type which_;
+
+        template <typename T, typename ... UTypes, typename ... Args>
+        friend void emplace(buffered_variant<UTypes...> &var, Args&&... args);
+        template <typename T, typename ... UTypes>
+        friend const T& get(const buffered_variant<UTypes...> &var);
+    };
+
+    /// \brief Whether or not a \ref buffered_variant currently contains an object of specific type.
+    /// \relates buffered_variant
+    template <typename T, typename ... Types>
+    bool contains(const buffered_variant<Types...> &var) noexcept
+    {
+        return var && var.which() == detail::get_index<T, Types...>();
+    }
+
+    /// \brief Emplaces a new object inside a \ref buffered_variant.
+    /// \detail If the type is already stored inside it, it will assign to it.
+    /// Otherwise the new object is constructed directly into the inactive storage slot;
+    /// only when that construction succeeded is the old object destroyed and the slot flipped.
+    /// This always provides the strong exception safety without needing a temporary.
+    /// \note The type must be one of the types specified.
+    /// \relates buffered_variant
+    template <typename T, typename ... Types, typename ... Args>
+    void emplace(buffered_variant<Types...> &var, Args&&... args)
+    {
+        using t = typename std::decay<T>::type;
+        constexpr auto index = detail::get_index<t, Types...>();
+        static_assert(index != buffered_variant<Types...>::invalid_index,
+                     "type is not one of the types specified");
+        if (var && index == var.which_)
+            // assign new value
+            var.template assign<t>(std::forward<Args>(args)...);
+        else
+        {
+            // construct into the inactive slot, the old value stays valid if this throws
+            auto inactive = static_cast<unsigned char>(var.active_ ^ 1u);
+            emplace<t>(var.storage_[inactive], std::forward<Args>(args)...);
+            // destroy the old value and flip the active slot
+            if (var)
+                visit(var, detail::variant_destroy_visitor());
+            var.active_ = inactive;
+        }
+        var.which_ = typename buffered_variant<Types...>::which_type(index);
+    }
+
+    /// @{
+    /// \brief Returns a reference to the object currently stored.
+    /// \detail You have to specify the type explicitly and it must be currently stored.
+    /// \relates buffered_variant
+    template <typename T, typename ... Types>
+    const T& get(const buffered_variant<Types...> &var)
+    {
+        assert((var && var.which() == detail::get_index<T, Types...>())
+            && "type not currently stored inside the variant");
+        return *get<T>(var.storage_[var.active_]);
+    }
+
+    template <typename T, typename ... Types>
+    T& get(buffered_variant<Types...> &var)
+    {
+        const buffered_variant<Types...> &cvar = var;
+        return const_cast<T&>(get<T>(cvar));
+    }
+
+    template <typename T, typename ... Types>
+    T&& get(buffered_variant<Types...> &&var)
+    {
+        return std::move(get<T>(var));
+    }
+    /// @}
+
+    /// @{
+    /// \brief Visits a \ref buffered_variant, the same as for \ref variant.
+    /// \relates buffered_variant
+    template <class Visitor, typename ... Types>
+    auto visit(const buffered_variant<Types...> &var, Visitor &&visitor)
+    -> detail::visit_result<Visitor&&, const buffered_variant<Types...>&, Types...>
+    {
+        return detail::variant_visit(variant_types<Types...>(),
+                                     std::forward<Visitor>(visitor), var);
+    }
+
+    template <class Visitor, typename ... Types>
+    auto visit(buffered_variant<Types...> &var, Visitor &&visitor)
+    -> detail::visit_result<Visitor&&, buffered_variant<Types...>&, Types...>
+    {
+        return detail::variant_visit(variant_types<Types...>(),
+                                     std::forward<Visitor>(visitor), var);
+    }
+
+    template <class Visitor, typename ... Types>
+    auto visit(buffered_variant<Types...> &&var, Visitor &&visitor)
+    -> detail::visit_result<Visitor&&, buffered_variant<Types...>&&, Types...>
+    {
+        return detail::variant_visit(variant_types<Types...>(),
+                                     std::forward<Visitor>(visitor), std::move(var));
+    }
+    /// @}
+}} // namespace foonathan::storage
+
+namespace std
+{
+    /// \brief Specialization of \c std::hash for \ref buffered_variant.
+    /// \detail Consistent with the specialization for \ref variant.
+    template <typename ... Types>
+    class hash<foonathan::storage::buffered_variant<Types...>>
+    {
+    public:
+        using argument_type = foonathan::storage::buffered_variant<Types...>;
+        using result_type = size_t;
+
+        result_type operator()(const argument_type &arg) const noexcept
+        {
+            if (!arg)
+                return static_cast<result_type>(19937); // magic value
+            return visit(arg, foonathan::storage::detail::variant_hash_visitor());
+        }
+    };
+} // namespace std
+
+#endif // FOONATHAN_STORAGE_BUFFERED_VARIANT_HPP_INCLUDED
@@ -0,0 +1,356 @@
+// Copyright (C) 2014 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_STORAGE_COMPACT_OPTIONAL_HPP_INCLUDED
+#define FOONATHAN_STORAGE_COMPACT_OPTIONAL_HPP_INCLUDED
+
+#include <cassert>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include "optional.hpp"
+
+namespace foonathan { namespace storage
+{
+    /// \brief A policy for \ref compact_optional designating a specific value as the null state.
+    /// \detail Useful for integers where e.g. \c INT_MIN never occurs as an actual value.
+    template <typename T, T Value>
+    struct sentinel_value
+    {
+        static constexpr T invalid_value() noexcept
+        {
+            return Value;
+        }
+
+        static constexpr bool is_invalid(const T &value) noexcept
+        {
+            return value == Value;
+        }
+    };
+
+    /// \brief A policy for \ref compact_optional using a quiet NaN as the null state.
+    /// \note Storing any NaN inside the optional is not allowed then.
+    template <typename T>
+    struct sentinel_nan
+    {
+        static_assert(std::is_floating_point<T>::value, "requires a floating point type");
+
+        static T invalid_value() noexcept
+        {
+            return std::numeric_limits<T>::quiet_NaN();
+        }
+
+        static bool is_invalid(const T &value) noexcept
+        {
+            return value != value;
+        }
+    };
+
+    /// \brief A policy for \ref compact_optional over pointers using the null pointer as the null state.
+    template <typename T>
+    struct sentinel_null_pointer
+    {
+        static_assert(std::is_pointer<T>::value, "requires a pointer type");
+
+        static constexpr T invalid_value() noexcept
+        {
+            return nullptr;
+        }
+
+        static constexpr bool is_invalid(const T &value) noexcept
+        {
+            return value == nullptr;
+        }
+    };
+
+    /// \brief A compact version of \ref optional without any storage overhead.
+    /// \detail Instead of a separate flag, a user supplied policy designates a sentinel
+    /// bit pattern of the type itself as the null state,
+    /// so \c sizeof(compact_optional<T, Policy>) is exactly \c sizeof(T).<br>
+    /// A \c Policy must provide two static functions,
+    /// \c invalid_value() returning the sentinel
+    /// and \c is_invalid(const T&) checking whether a value is the sentinel.
+    /// \note A value for which the policy reports the sentinel must never be stored.
+    template <typename T, class Policy>
+    class compact_optional
+    {
+        static_assert(!std::is_reference<T>::value, "can't store references");
+        using nothrow_move = std::is_nothrow_move_constructible<T>;
+    public:
+        //=== typedefs ===//
+        using value_type = T;
+        using policy = Policy;
+
+        //=== constructors/destructor/assignment/swap ===//
+        /// @{
+        /// \brief Creates a null optional storing the sentinel value.
+        compact_optional() noexcept
+        : value_(Policy::invalid_value()) {}
+
+        compact_optional(nullopt_t) noexcept
+        : compact_optional() {}
+        /// @}
+
+        /// @{
+        /// \brief Initializes it with a value.
+        /// \note The value must not be the sentinel.
+        compact_optional(const value_type &val)
+        : value_(val)
+        {
+            assert(!Policy::is_invalid(value_) && "must not store the sentinel value");
+        }
+
+        compact_optional(value_type &&val) noexcept(nothrow_move::value)
+        : value_(std::move(val))
+        {
+            assert(!Policy::is_invalid(value_) && "must not store the sentinel value");
+        }
+        /// @}
+
+        /// \brief Assigns a null state by storing the sentinel value again.
+        compact_optional& operator=(nullopt_t) noexcept
+        {
+            value_ = Policy::invalid_value();
+            return *this;
+        }
+
+        /// @{
+        /// \brief Assigns a new value.
+        /// \note The value must not be the sentinel.
+        compact_optional& operator=(const value_type &val)
+        {
+            value_ = val;
+            assert(!Policy::is_invalid(value_) && "must not store the sentinel value");
+            return *this;
+        }
+
+        compact_optional& operator=(value_type &&val)
+        {
+            value_ = std::move(val);
+            assert(!Policy::is_invalid(value_) && "must not store the sentinel value");
+            return *this;
+        }
+        /// @}
+
+        /// \brief Swaps two optionals.
+        /// \detail Since the null state is a value as well, this is just a swap of the values.
+        friend void swap(compact_optional &a, compact_optional &b) noexcept(nothrow_move::value)
+        {
+            using std::swap;
+            swap(a.value_, b.value_);
+        }
+
+        //=== access ===//
+        /// @{
+        /// \brief Returns the stored object.
+        /// \note The optional must not be in null state.
+        value_type& operator*()
+        {
+            assert(*this && "optional must not be in null state");
+            return value_;
+        }
+
+        const value_type& operator*() const
+        {
+            assert(*this && "optional must not be in null state");
+            return value_;
+        }
+
+        value_type* operator->()
+        {
+            return &operator*();
+        }
+
+        const value_type* operator->() const
+        {
+            return &operator*();
+        }
+        /// @}
+
+        /// \brief Returns \c true if there is a value stored, \c false otherwise.
+        explicit operator bool() const noexcept
+        {
+            return !Policy::is_invalid(value_);
+        }
+
+        //=== comparison ===//
+        /// @{
+        /// \brief Compares two optionals for (in-)equality.
+        /// \detail They are equal if both null or both non-null and the stored value is the same.
+        friend bool operator==(const compact_optional &a, const compact_optional &b)
+        {
+            if (a && b)
+                return *a == *b;
+            return !a && !b;
+        }
+
+        friend bool operator!=(const compact_optional &a, const compact_optional &b)
+        {
+            return !(a == b);
+        }
+        /// @}
+
+        /// @{
+        /// \brief Compares an optional with a value.
+        friend bool operator==(const compact_optional &a, const value_type &b)
+        {
+            return a && *a == b;
+        }
+
+        friend bool operator==(const value_type &a, const compact_optional &b)
+        {
+            return b == a;
+        }
+
+        friend bool operator!=(const compact_optional &a, const value_type &b)
+        {
+            return !(a == b);
+        }
+
+        friend bool operator!=(const value_type &a, const compact_optional &b)
+        {
+            return !(b == a);
+        }
+        /// @}
+
+        /// @{
+        /// \brief Compares an optional and \ref nullopt_t.
+        /// \detail This is the same as asking an optional for validity.
+        friend bool operator==(const compact_optional &a, nullopt_t) noexcept
+        {
+            return !a;
+        }
+
+        friend bool operator==(nullopt_t, const compact_optional &b) noexcept
+        {
+            return !b;
+        }
+
+        friend bool operator!=(const compact_optional &a, nullopt_t) noexcept
+        {
+            return a;
+        }
+
+        friend bool operator!=(nullopt_t, const compact_optional &b) noexcept
+        {
+            return b;
+        }
+        /// @}
+
+    private:
+        // single argument that can be assigned
+        template <typename U>
+        void assign(U &&u,
+                    decltype(std::declval<T&>() = std::forward<U>(u), int()) = 0)
+        {
+            value_ = std::forward<U>(u);
+        }
+
+        // multiple arguments or single one that can't be assigned directly
+        template <typename ... Args>
+        void assign(Args&&... args)
+        {
+            value_ = T(std::forward<Args>(args)...);
+        }
+
+        value_type value_;
+
+        template <typename U, class P, typename ... Args>
+        friend void emplace(compact_optional<U, P> &opt, Args&&... args);
+    };
+
+    /// \brief Emplaces a value inside a \ref compact_optional.
+    /// \detail Since the value is always alive, this always assigns.
+    /// \note The new value must not be the sentinel.
+    /// \relates compact_optional
+    template <typename T, class Policy, typename ... Args>
+    void emplace(compact_optional<T, Policy> &opt, Args&&... args)
+    {
+        opt.assign(std::forward<Args>(args)...);
+        assert(opt && "must not store the sentinel value");
+    }
+
+    /// @{
+    /// \brief Returns the stored value of a \ref compact_optional.
+    /// \detail This is the same as \ref compact_optional::operator*().
+    /// \relates compact_optional
+    template <typename T, class Policy>
+    const T& get(const compact_optional<T, Policy> &opt)
+    {
+        return *opt;
+    }
+
+    template <typename T, class Policy>
+    T& get(compact_optional<T, Policy> &opt)
+    {
+        return *opt;
+    }
+
+    template <typename T, class Policy>
+    T&& get(compact_optional<T, Policy> &&opt)
+    {
+        return std::move(*opt);
+    }
+    /// @}
+
+    /// \brief Tries to return a copy of the stored value inside a \ref compact_optional.
+    /// \detail If there is not a value stored, it returns \c val.
+    /// \relates compact_optional
+    template <typename T, class Policy, typename U>
+    T try_get(const compact_optional<T, Policy> &opt, U &&val)
+    {
+        if (opt)
+            return *opt;
+        return std::forward<U>(val);
+    }
+
+    /// @{
+    /// \brief Visits a \ref compact_optional.
+    /// \detail This is the same behavior as for \ref optional:
+    /// the visitor is only called when there is a value stored.
+    /// \relates compact_optional
+    template <class Visitor, typename T, class Policy>
+    void visit(const compact_optional<T, Policy> &opt, Visitor &&visitor)
+    {
+        if (opt)
+            std::forward<Visitor>(visitor)(*opt);
+    }
+
+    template <class Visitor, typename T, class Policy>
+    void visit(compact_optional<T, Policy> &opt, Visitor &&visitor)
+    {
+        if (opt)
+            std::forward<Visitor>(visitor)(*opt);
+    }
+
+    template <class Visitor, typename T, class Policy>
+    void visit(compact_optional<T, Policy> &&opt, Visitor &&visitor)
+    {
+        if (opt)
+            std::forward<Visitor>(visitor)(std::move(*opt));
+    }
+    /// @}
+}} // namespace foonathan::storage
+
+namespace std
+{
+    /// \brief Specialization of \c std::hash for \ref compact_optional.
+    /// \detail Consistent with the specialization for \ref optional.
+    template <typename T, class Policy>
+    class hash<foonathan::storage::compact_optional<T, Policy>>
+    {
+    public:
+        using argument_type = foonathan::storage::compact_optional<T, Policy>;
+        using result_type = size_t;
+
+        result_type operator()(const argument_type &arg) const noexcept
+        {
+            return arg ? hash<T>()(*arg) :
+                  static_cast<result_type>(19937); // magic value
+        }
+    };
+} // namespace std
+
+#endif // FOONATHAN_STORAGE_COMPACT_OPTIONAL_HPP_INCLUDED
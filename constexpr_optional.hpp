@@ -0,0 +1,137 @@
+// Copyright (C) 2014 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_STORAGE_CONSTEXPR_OPTIONAL_HPP_INCLUDED
+#define FOONATHAN_STORAGE_CONSTEXPR_OPTIONAL_HPP_INCLUDED
+
+#include <stdexcept>
+#include <type_traits>
+
+#include "optional.hpp"
+
+namespace foonathan { namespace storage
+{
+    /// \brief An \ref optional usable in constant expressions.
+    /// \detail Instead of placement new into aligned storage it stores the value
+    /// in a union member, so instances can live in \c .rodata:
+    /// construction, access and comparison all work at compile-time.
+    /// The price is immutability - there is no emplace or assignment -
+    /// and that the type must be a trivially destructible literal type.
+    /// \note Accessing a null optional throws \c std::logic_error at runtime
+    /// and fails to compile in a constant expression.
+    template <typename T>
+    class constexpr_optional
+    {
+    public:
+        //=== typedefs ===//
+        using value_type = T;
+
+        //=== constructors ===//
+        /// @{
+        /// \brief Creates a null optional.
+        /// \note The requirements are checked here instead of at class scope,
+        /// so merely forming the type during overload resolution of an unrelated \c get()
+        /// does not hard-error for other types.
+        constexpr constexpr_optional() noexcept
+        : dummy_(0), null_(true)
+        {
+            static_assert(!std::is_reference<value_type>::value, "can't store references");
+            static_assert(std::is_trivially_destructible<value_type>::value,
+                          "type must be trivially destructible");
+        }
+
+        constexpr constexpr_optional(nullopt_t) noexcept
+        : constexpr_optional() {}
+        /// @}
+
+        /// \brief Initializes it with a value.
+        constexpr constexpr_optional(value_type value) noexcept
+        : value_(value), null_(false)
+        {
+            static_assert(std::is_trivially_destructible<value_type>::value,
+                          "type must be trivially destructible");
+        }
+
+        //=== access ===//
+        /// \brief Returns a copy of the stored value.
+        /// \note The optional must not be in null state.
+        constexpr value_type operator*() const
+        {
+            return null_ ? throw std::logic_error("optional must not be in null state")
+                         : value_;
+        }
+
+        /// \brief Returns \c true if there is an object stored, \c false otherwise.
+        constexpr explicit operator bool() const noexcept
+        {
+            return !null_;
+        }
+
+        //=== comparison ===//
+        /// @{
+        /// \brief Compares two optionals for (in-)equality at compile-time.
+        /// \detail They are equal if both null or both non-null and the stored value is the same.
+        friend constexpr bool operator==(const constexpr_optional &a, const constexpr_optional &b)
+        {
+            return a && b ? *a == *b : !a && !b;
+        }
+
+        friend constexpr bool operator!=(const constexpr_optional &a, const constexpr_optional &b)
+        {
+            return !(a == b);
+        }
+        /// @}
+
+        /// @{
+        /// \brief Compares an optional with a value.
+        friend constexpr bool operator==(const constexpr_optional &a, const value_type &b)
+        {
+            return a && *a == b;
+        }
+
+        friend constexpr bool operator==(const value_type &a, const constexpr_optional &b)
+        {
+            return b == a;
+        }
+
+        friend constexpr bool operator!=(const constexpr_optional &a, const value_type &b)
+        {
+            return !(a == b);
+        }
+
+        friend constexpr bool operator!=(const value_type &a, const constexpr_optional &b)
+        {
+            return !(b == a);
+        }
+        /// @}
+
+    private:
+        union
+        {
+            char dummy_;
+            value_type value_;
+        };
+        bool null_;
+    };
+
+    /// \brief Returns a copy of the stored value of a \ref constexpr_optional.
+    /// \detail This is the same as \ref constexpr_optional::operator*().
+    /// \relates constexpr_optional
+    template <typename T>
+    constexpr T get(const constexpr_optional<T> &opt)
+    {
+        return *opt;
+    }
+
+    /// \brief Tries to return a copy of the stored value inside a \ref constexpr_optional.
+    /// \detail If there is not an object stored, it returns \c val.
+    /// \relates constexpr_optional
+    template <typename T>
+    constexpr T try_get(const constexpr_optional<T> &opt, T val)
+    {
+        return opt ? *opt : val;
+    }
+}} // namespace foonathan::storage
+
+#endif // FOONATHAN_STORAGE_CONSTEXPR_OPTIONAL_HPP_INCLUDED
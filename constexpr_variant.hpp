@@ -0,0 +1,187 @@
+// Copyright (C) 2014 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_STORAGE_CONSTEXPR_VARIANT_HPP_INCLUDED
+#define FOONATHAN_STORAGE_CONSTEXPR_VARIANT_HPP_INCLUDED
+
+#include <stdexcept>
+
+#include "detail/constexpr_union.hpp"
+#include "variant.hpp"
+
+namespace foonathan { namespace storage
+{
+    /// \brief A \ref variant usable in constant expressions.
+    /// \detail Instead of placement new into aligned storage it is built on a
+    /// recursive union, so instances can live in \c .rodata:
+    /// construction, \ref get(), \ref which() and comparison all work at compile-time,
+    /// e.g. for dispatch tables that are arrays of variants.
+    /// The price is immutability - there is no emplace or assignment -
+    /// and that all types must be trivially destructible literal types.
+    /// \note Accessing the wrong alternative throws \c std::logic_error at runtime
+    /// and fails to compile in a constant expression.
+    template <typename ... Types>
+    class constexpr_variant
+    {
+        static_assert(detail::valid_types<Types...>(), "can't store references");
+    public:
+        //=== statics ===//
+        /// \brief Represents an invalid index of a type.
+        static constexpr auto invalid_index = sizeof...(Types);
+
+        /// \brief The types.
+        using types = variant_types<Types...>;
+
+        //=== constructors ===//
+        /// @{
+        /// \brief Creates a null variant.
+        constexpr constexpr_variant() noexcept
+        : union_(), which_(invalid_index) {}
+
+        constexpr constexpr_variant(nullvar_t) noexcept
+        : constexpr_variant() {}
+        /// @}
+
+        /// \brief Initializes a variant with a value.
+        /// \note The type must be one of the types specified.
+        template <typename T>
+        constexpr constexpr_variant(T value) noexcept
+        : union_(detail::union_index_t<detail::get_index<T, Types...>()>(), value),
+          which_(detail::get_index<T, Types...>())
+        {
+            static_assert(detail::get_index<T, Types...>() != invalid_index,
+                          "type is not one of the types specified");
+        }
+
+        //=== accessors ===//
+        /// \brief Returns \c true if there is an object currently stored inside the variant.
+        constexpr explicit operator bool() const noexcept
+        {
+            return which_ != invalid_index;
+        }
+
+        /// \brief Returns the index of the type of the currently stored inside the variant.
+        /// \detail If the variant is not vaild, it returns \ref invalid_index.
+        constexpr std::size_t which() const noexcept
+        {
+            return which_;
+        }
+
+    private:
+        detail::constexpr_union<Types...> union_;
+        std::size_t which_;
+
+        template <typename T, typename ... UTypes>
+        friend constexpr T get(const constexpr_variant<UTypes...> &var);
+    };
+
+    /// \brief Whether or not a \ref constexpr_variant currently contains an object of specific type.
+    /// \relates constexpr_variant
+    template <typename T, typename ... Types>
+    constexpr bool contains(const constexpr_variant<Types...> &var) noexcept
+    {
+        return var.which() == detail::get_index<T, Types...>();
+    }
+
+    /// @{
+    /// \brief Returns a copy of the object currently stored.
+    /// \detail You have to specify the type explicitly and it must be currently stored.
+    /// \relates constexpr_variant
+    template <typename T, typename ... Types>
+    constexpr T get(const constexpr_variant<Types...> &var)
+    {
+        return contains<T>(var)
+             ? detail::constexpr_union_get(var.union_,
+                       detail::union_index_t<detail::get_index<T, Types...>()>())
+             : throw std::logic_error("type not currently stored inside the variant");
+    }
+
+    // the unconstrained raw storage get would be a better match otherwise
+    template <typename T, typename ... Types>
+    constexpr T get(constexpr_variant<Types...> &var)
+    {
+        return get<T>(static_cast<const constexpr_variant<Types...>&>(var));
+    }
+    /// @}
+
+    /// \brief Tries to return a copy of the stored value of specific type.
+    /// \detail If another type or nothing is stored, it returns \c val.
+    /// \relates constexpr_variant
+    template <typename T, typename ... Types>
+    constexpr T try_get(const constexpr_variant<Types...> &var, T val)
+    {
+        return contains<T>(var) ? get<T>(var) : val;
+    }
+
+    namespace detail
+    {
+        template <typename ... Types>
+        constexpr bool constexpr_variant_equal(variant_types<>,
+                                               const constexpr_variant<Types...> &,
+                                               const constexpr_variant<Types...> &)
+        {
+            return false;
+        }
+
+        template <typename Head, typename ... Tail, typename ... Types>
+        constexpr bool constexpr_variant_equal(variant_types<Head, Tail...>,
+                                               const constexpr_variant<Types...> &a,
+                                               const constexpr_variant<Types...> &b)
+        {
+            return contains<Head>(a)
+                 ? get<Head>(a) == get<Head>(b)
+                 : constexpr_variant_equal(variant_types<Tail...>(), a, b);
+        }
+    } // namespace detail
+
+    /// @{
+    /// \brief Compares two variants for (in-)equality at compile-time.
+    /// \detail They are equal, if either both are invalid or store the same object.
+    /// \relates constexpr_variant
+    template <typename ... Types>
+    constexpr bool operator==(const constexpr_variant<Types...> &a,
+                              const constexpr_variant<Types...> &b)
+    {
+        return a.which() == b.which()
+            && (!a || detail::constexpr_variant_equal(variant_types<Types...>(), a, b));
+    }
+
+    template <typename ... Types>
+    constexpr bool operator!=(const constexpr_variant<Types...> &a,
+                              const constexpr_variant<Types...> &b)
+    {
+        return !(a == b);
+    }
+    /// @}
+
+    /// @{
+    /// \brief Compares a variant with a value.
+    /// \relates constexpr_variant
+    template <typename T, typename ... Types>
+    constexpr bool operator==(const constexpr_variant<Types...> &a, const T &b)
+    {
+        return contains<T>(a) && get<T>(a) == b;
+    }
+
+    template <typename T, typename ... Types>
+    constexpr bool operator==(const T &a, const constexpr_variant<Types...> &b)
+    {
+        return b == a;
+    }
+
+    template <typename T, typename ... Types>
+    constexpr bool operator!=(const constexpr_variant<Types...> &a, const T &b)
+    {
+        return !(a == b);
+    }
+
+    template <typename T, typename ... Types>
+    constexpr bool operator!=(const T &a, const constexpr_variant<Types...> &b)
+    {
+        return !(b == a);
+    }
+    /// @}
+}} // namespace foonathan::storage
+
+#endif // FOONATHAN_STORAGE_CONSTEXPR_VARIANT_HPP_INCLUDED
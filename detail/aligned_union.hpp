@@ -5,6 +5,7 @@
 #ifndef FOONATHAN_STORAGE_DETAIL_ALIGNED_UNION_HPP_INCLUDED
 #define FOONATHAN_STORAGE_DETAIL_ALIGNED_UNION_HPP_INCLUDED
 
+#include <cstddef>
 #include <type_traits>
 
 namespace foonathan { namespace storage { namespace detail
@@ -40,6 +41,27 @@ namespace foonathan { namespace storage { namespace detail
 
     template  <typename ... Types>
     using aligned_union_t = typename aligned_union<Types...>::type;
+
+    // rounds size up to the next multiple of alignment
+    constexpr std::size_t round_up(std::size_t size, std::size_t alignment)
+    {
+        return (size + alignment - 1u) / alignment * alignment;
+    }
+
+    // an aligned_union whose alignment can be raised above the natural one;
+    // the size is padded to a multiple of the alignment,
+    // so arrays of it never share an alignment boundary
+    template <std::size_t Alignment, typename ... Types>
+    struct over_aligned_union
+    {
+        static constexpr auto size_value =
+            round_up(detail::max(sizeof(Types)...),
+                     detail::max(Alignment, detail::max(alignof(Types)...)));
+        static constexpr auto alignment_value =
+            detail::max(Alignment, detail::max(alignof(Types)...));
+
+        using type = typename std::aligned_storage<size_value, alignment_value>::type;
+    };
 }}} // namespace foonathan::storage
 
 #endif // FOONATHAN_STORAGE_DETAIL_ALIGNED_UNION_HPP_INCLUDED
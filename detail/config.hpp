@@ -0,0 +1,37 @@
+// Copyright (C) 2014 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_STORAGE_DETAIL_CONFIG_HPP_INCLUDED
+#define FOONATHAN_STORAGE_DETAIL_CONFIG_HPP_INCLUDED
+
+// branch prediction hints,
+// they expand to the plain condition when the compiler has no __builtin_expect
+#if defined(__GNUC__)
+    #define FOONATHAN_STORAGE_LIKELY(Cond) __builtin_expect(!!(Cond), 1)
+    #define FOONATHAN_STORAGE_UNLIKELY(Cond) __builtin_expect(!!(Cond), 0)
+#else
+    #define FOONATHAN_STORAGE_LIKELY(Cond) (Cond)
+    #define FOONATHAN_STORAGE_UNLIKELY(Cond) (Cond)
+#endif
+
+// applies std::launder where the standard library provides it,
+// telling the optimizer that the pointer refers to a live object of its type;
+// <new> must be included first, it defines the feature test macro
+#include <new>
+#if defined(__cpp_lib_launder) && __cpp_lib_launder >= 201606
+    #define FOONATHAN_STORAGE_LAUNDER(Ptr) std::launder(Ptr)
+#else
+    #define FOONATHAN_STORAGE_LAUNDER(Ptr) (Ptr)
+#endif
+
+// propagates an alignment guarantee the type system cannot express,
+// e.g. from the aligned union a pointer points into
+#if defined(__GNUC__)
+    #define FOONATHAN_STORAGE_ASSUME_ALIGNED(Ptr, Align) \
+        static_cast<decltype(Ptr)>(__builtin_assume_aligned((Ptr), (Align)))
+#else
+    #define FOONATHAN_STORAGE_ASSUME_ALIGNED(Ptr, Align) (Ptr)
+#endif
+
+#endif // FOONATHAN_STORAGE_DETAIL_CONFIG_HPP_INCLUDED
@@ -0,0 +1,61 @@
+// Copyright (C) 2014 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_STORAGE_DETAIL_CONSTEXPR_UNION_HPP_INCLUDED
+#define FOONATHAN_STORAGE_DETAIL_CONSTEXPR_UNION_HPP_INCLUDED
+
+#include <cstddef>
+
+namespace foonathan { namespace storage { namespace detail
+{
+    // selects a member of constexpr_union by index
+    template <std::size_t I>
+    struct union_index_t {};
+
+    // a recursive union usable in constant expressions,
+    // unlike aligned storage which requires placement new;
+    // all types must be trivially destructible
+    template <typename ... Types>
+    union constexpr_union;
+
+    template <>
+    union constexpr_union<>
+    {
+        char dummy;
+
+        constexpr constexpr_union() : dummy(0) {}
+    };
+
+    template <typename Head, typename ... Tail>
+    union constexpr_union<Head, Tail...>
+    {
+        Head head;
+        constexpr_union<Tail...> tail;
+
+        constexpr constexpr_union() : tail() {}
+
+        constexpr constexpr_union(union_index_t<0>, Head value)
+        : head(value) {}
+
+        template <std::size_t I, typename T>
+        constexpr constexpr_union(union_index_t<I>, T value)
+        : tail(union_index_t<I - 1u>(), value) {}
+    };
+
+    // returns the member with the given index, it must be the active one
+    template <typename Head, typename ... Tail>
+    constexpr Head constexpr_union_get(const constexpr_union<Head, Tail...> &u, union_index_t<0>)
+    {
+        return u.head;
+    }
+
+    template <std::size_t I, typename Head, typename ... Tail>
+    constexpr auto constexpr_union_get(const constexpr_union<Head, Tail...> &u, union_index_t<I>)
+    -> decltype(constexpr_union_get(u.tail, union_index_t<I - 1u>()))
+    {
+        return constexpr_union_get(u.tail, union_index_t<I - 1u>());
+    }
+}}} // namespace foonathan::storage::detail
+
+#endif // FOONATHAN_STORAGE_DETAIL_CONSTEXPR_UNION_HPP_INCLUDED
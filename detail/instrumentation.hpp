@@ -0,0 +1,140 @@
+// Copyright (C) 2014 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_STORAGE_DETAIL_INSTRUMENTATION_HPP_INCLUDED
+#define FOONATHAN_STORAGE_DETAIL_INSTRUMENTATION_HPP_INCLUDED
+
+// Opt-in hot path instrumentation.
+// When FOONATHAN_STORAGE_INSTRUMENTATION is defined before including the library,
+// the emplace/swap/visit entry points count their operations
+// per type in thread local counters,
+// which \ref aggregate_operation_counts() merges on demand.
+// Without the macro every hook expands to nothing.
+
+#if defined(FOONATHAN_STORAGE_INSTRUMENTATION)
+
+#include <cstddef>
+#include <cstring>
+#include <mutex>
+#include <typeinfo>
+#include <vector>
+
+namespace foonathan { namespace storage
+{
+    /// \brief The operations counted by the instrumentation mode.
+    enum class counted_operation : unsigned char
+    {
+        emplace_assign,    ///< emplace assigned to the already stored value of the same type
+        emplace_construct, ///< emplace constructed directly into empty or trivial storage
+        emplace_temporary, ///< emplace took the cross-type route over a temporary
+        swap_value,        ///< swap exchanged two stored values
+        swap_move,         ///< swap moved a value into the empty side
+        visit_dispatch,    ///< a visitation dispatched on this stored type
+        count_             ///< number of operations, not a counter
+    };
+
+    namespace detail
+    {
+        constexpr auto counted_operations = static_cast<std::size_t>(counted_operation::count_);
+
+        // one thread's counters for one type, linked into the global registry
+        struct counter_node
+        {
+            const char *type_name;
+            std::size_t counts[counted_operations];
+            counter_node *next;
+
+            counter_node(const char *name)
+            : type_name(name), counts(), next(nullptr)
+            {
+                auto &registry = counter_registry();
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                next = registry.head;
+                registry.head = this;
+            }
+
+            struct registry_t
+            {
+                std::mutex mutex;
+                counter_node *head = nullptr;
+            };
+
+            static registry_t& counter_registry()
+            {
+                static registry_t registry;
+                return registry;
+            }
+        };
+
+        // the nodes are heap allocated and intentionally leaked,
+        // so aggregation stays valid after the owning thread has exited
+        template <typename T>
+        counter_node& counters_for()
+        {
+            thread_local counter_node *node = new counter_node(typeid(T).name());
+            return *node;
+        }
+
+        template <typename T>
+        void count_operation(counted_operation op)
+        {
+            ++counters_for<T>().counts[static_cast<std::size_t>(op)];
+        }
+    } // namespace detail
+
+    /// \brief The aggregated counters of one type, see \ref aggregate_operation_counts().
+    struct operation_counts
+    {
+        /// \brief The implementation defined name of the type, as returned by \c typeid.
+        const char *type_name;
+
+        /// \brief The number of operations, indexed by \ref counted_operation.
+        std::size_t counts[detail::counted_operations];
+
+        /// \brief Returns the counter of a single operation.
+        std::size_t operator[](counted_operation op) const noexcept
+        {
+            return counts[static_cast<std::size_t>(op)];
+        }
+    };
+
+    /// \brief Merges the counters of all threads into one entry per distinct type.
+    /// \detail Counting continues while aggregating,
+    /// the result is a snapshot that may miss increments happening concurrently.
+    inline std::vector<operation_counts> aggregate_operation_counts()
+    {
+        std::vector<operation_counts> result;
+        auto &registry = detail::counter_node::counter_registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        for (auto node = registry.head; node; node = node->next)
+        {
+            operation_counts *entry = nullptr;
+            for (auto &existing : result)
+                if (std::strcmp(existing.type_name, node->type_name) == 0)
+                {
+                    entry = &existing;
+                    break;
+                }
+            if (!entry)
+            {
+                result.push_back(operation_counts{node->type_name, {}});
+                entry = &result.back();
+            }
+            for (std::size_t i = 0u; i != detail::counted_operations; ++i)
+                entry->counts[i] += node->counts[i];
+        }
+        return result;
+    }
+}} // namespace foonathan::storage
+
+#define FOONATHAN_STORAGE_COUNT_OPERATION(Type, Op) \
+    foonathan::storage::detail::count_operation<Type>(foonathan::storage::counted_operation::Op)
+
+#else
+
+#define FOONATHAN_STORAGE_COUNT_OPERATION(Type, Op) static_cast<void>(0)
+
+#endif
+
+#endif // FOONATHAN_STORAGE_DETAIL_INSTRUMENTATION_HPP_INCLUDED
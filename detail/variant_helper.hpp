@@ -5,9 +5,14 @@
 #ifndef FOONATHAN_STORAGE_DETAIL_VARIANT_HELPER_HPP_INCLUDED
 #define FOONATHAN_STORAGE_DETAIL_VARIANT_HELPER_HPP_INCLUDED
 
+#include <cassert>
+#include <climits>
 #include <functional>
 #include <type_traits>
 
+#include "../raw_storage.hpp"
+#include "instrumentation.hpp"
+
 namespace foonathan { namespace storage { namespace detail
 {
     template <typename ... Types>
@@ -25,32 +30,62 @@ namespace foonathan { namespace storage { namespace detail
     template <typename T, typename ... Types, typename ... Args>
     void emplace(variant<Types...> &var, Args&&... args);
 
+    // make the raw storage overload visible here as well;
+    // it cannot be found via argument dependent lookup
+    // since the aligned union lives in namespace std
+    using foonathan::storage::emplace;
+
     //=== get_index implementation ===//
+    // the index is found by a constexpr scan over a flag array
+    // instead of recursive class template instantiations,
+    // so looking up a type in a pack of N costs one instantiation of depth one,
+    // not a chain of N - this matters for compile times of wide variants
     template <typename T, typename ... Types>
-    struct get_index_t;
-
-    template <typename T, typename Head, typename ... Tail>
-    struct get_index_t<T, Head, Tail...>
-    : std::integral_constant<std::size_t, get_index_t<T, Tail...>::value + 1> {};
+    struct type_match_flags
+    {
+        // the trailing entry avoids a zero-sized array for empty packs
+        static constexpr bool flags[sizeof...(Types) + 1] = {std::is_same<T, Types>::value..., false};
+    };
 
-    template <typename T, typename ... Tail>
-    struct get_index_t<T, T, Tail...>
-    : std::integral_constant<std::size_t, 0> {};
+    template <typename T, typename ... Types>
+    constexpr bool type_match_flags<T, Types...>::flags[sizeof...(Types) + 1];
 
-    template <typename T>
-    struct get_index_t<T>
-    : std::integral_constant<std::size_t, 0> {};
+    constexpr std::size_t first_match(const bool *flags, std::size_t size, std::size_t i = 0u)
+    {
+        return i == size ? size : flags[i] ? i : first_match(flags, size, i + 1u);
+    }
 
     template <typename T, typename ... Types>
     constexpr std::size_t get_index() noexcept
     {
-        return get_index_t<T, Types...>::value;
+        return first_match(type_match_flags<T, Types...>::flags, sizeof...(Types));
     }
 
+    //=== compact discriminant ===//
+    // the smallest unsigned integer type able to hold the values 0 to Max,
+    // used as discriminant to pack it into the padding of the aligned union
+    template <std::size_t Max>
+    using compact_index_t = typename std::conditional<Max <= UCHAR_MAX, unsigned char,
+                            typename std::conditional<Max <= USHRT_MAX, unsigned short,
+                            typename std::conditional<Max <= UINT_MAX, unsigned int,
+                                std::size_t>::type>::type>::type;
+
     //=== query information ===//
     template <typename ... Types>
     struct variant_types {};
 
+    template <std::size_t I, typename ... Types>
+    struct type_at;
+
+    template <typename Head, typename ... Tail>
+    struct type_at<0, Head, Tail...>
+    {
+        using type = Head;
+    };
+
+    template <std::size_t I, typename Head, typename ... Tail>
+    struct type_at<I, Head, Tail...> : type_at<I - 1, Tail...> {};
+
     template <typename ... Types>
     using all_true_types = variant_types<typename std::conditional<true, std::true_type, Types>::type...>;
 
@@ -71,6 +106,13 @@ namespace foonathan { namespace storage { namespace detail
         return std::is_same<is_trivial_types, all_true_types<Types...>>::value;
     }
 
+    template <typename ... Types>
+    constexpr bool relocatable_types() noexcept
+    {
+        using is_relocatable_types = variant_types<select_type<is_trivially_relocatable<Types>::value>...>;
+        return std::is_same<is_relocatable_types, all_true_types<Types...>>::value;
+    }
+
     template <typename ... Types>
     constexpr bool nothrow_move_types() noexcept
     {
@@ -79,21 +121,303 @@ namespace foonathan { namespace storage { namespace detail
     }
 
     //=== visit implementation ===//
-    template <typename T, class Visitor, class Variant>
-    void call_visitor(Visitor &&visitor, Variant &&variant)
+    // the result of a visitation, deduced from calling the visitor with the first type;
+    // the other operator() overloads must return a type convertible to it
+    template <class Visitor, class Variant, typename ... Types>
+    using visit_result = decltype(std::declval<Visitor>()(
+        get<typename type_at<0, Types...>::type>(std::declval<Variant>())));
+
+    template <typename R, typename T, class Visitor, class Variant>
+    R call_visitor(Visitor &&visitor, Variant &&variant)
+    {
+        FOONATHAN_STORAGE_COUNT_OPERATION(T, visit_dispatch);
+        return static_cast<R>(std::forward<Visitor>(visitor)(get<T>(std::forward<Variant>(variant))));
+    }
+
+    // maximum number of types where visit dispatches via an if-chain instead of a table
+    constexpr std::size_t max_inline_visit_types = 8u;
+
+    // single type left, it must be the stored one
+    template <typename R, typename Head, class Visitor, class Variant>
+    R variant_visit_switch(std::size_t, variant_types<Head>,
+                           Visitor &&visitor, Variant &&variant)
+    {
+        return call_visitor<R, Head>(std::forward<Visitor>(visitor), std::forward<Variant>(variant));
+    }
+
+    template <typename R, typename Head, typename Second, typename ... Tail, class Visitor, class Variant>
+    R variant_visit_switch(std::size_t which, variant_types<Head, Second, Tail...>,
+                           Visitor &&visitor, Variant &&variant)
+    {
+        if (which == 0u)
+            return call_visitor<R, Head>(std::forward<Visitor>(visitor), std::forward<Variant>(variant));
+        return variant_visit_switch<R>(which - 1u, variant_types<Second, Tail...>(),
+                                       std::forward<Visitor>(visitor), std::forward<Variant>(variant));
+    }
+
+    // small pack: dispatch via an if-chain the compiler turns into a jump table,
+    // this allows inlining the visitor
+    template <typename R, typename ... Types, class Visitor, class Variant>
+    R variant_visit_impl(std::true_type, variant_types<Types...>,
+                         Visitor &&visitor, Variant &&variant)
+    {
+        return variant_visit_switch<R>(variant.which(), variant_types<Types...>(),
+                                       std::forward<Visitor>(visitor), std::forward<Variant>(variant));
+    }
+
+    // the function pointer table for a visitation,
+    // a static constant so it is emitted once into .rodata
+    // instead of being built on every call;
+    // per visitor it instantiates nothing but the call_visitor per type
+    template <typename R, class Visitor, class Variant, typename ... Types>
+    struct visit_table
+    {
+        using visit_fnc = R(*)(Visitor&&, Variant&&);
+
+        static constexpr visit_fnc fncs[sizeof...(Types)] = {&call_visitor<R, Types, Visitor, Variant>...};
+    };
+
+    template <typename R, class Visitor, class Variant, typename ... Types>
+    constexpr typename visit_table<R, Visitor, Variant, Types...>::visit_fnc
+        visit_table<R, Visitor, Variant, Types...>::fncs[sizeof...(Types)];
+
+    // big pack: dispatch via the table of function pointers to keep code size small
+    template <typename R, typename ... Types, class Visitor, class Variant>
+    R variant_visit_impl(std::false_type, variant_types<Types...>,
+                         Visitor &&visitor, Variant &&variant)
     {
-        std::forward<Visitor>(visitor)(get<T>(std::forward<Variant>(variant)));
+        return visit_table<R, Visitor&&, Variant&&, Types...>::fncs[variant.which()](
+                   std::forward<Visitor>(visitor), std::forward<Variant>(variant));
     }
 
+    // void visitation, a null variant is simply ignored
     template <typename ... Types, class Visitor, class Variant>
-    void variant_visit(variant_types<Types...>, Visitor &&visitor, Variant &&variant)
+    void variant_visit_null(std::true_type, variant_types<Types...>,
+                            Visitor &&visitor, Variant &&variant)
     {
         if (!variant)
             return;
 
-        using visit_fnc = void(*)(Visitor&&, Variant&&);
-        visit_fnc fncs[] = {static_cast<visit_fnc>(&call_visitor<Types, Visitor, Variant>)...};
-        fncs[variant.which()](std::forward<Visitor>(visitor), std::forward<Variant>(variant));
+        variant_visit_impl<void>(select_type<sizeof...(Types) <= max_inline_visit_types>(),
+                                 variant_types<Types...>(),
+                                 std::forward<Visitor>(visitor), std::forward<Variant>(variant));
+    }
+
+    // value returning visitation, the variant must not be null
+    template <typename ... Types, class Visitor, class Variant>
+    auto variant_visit_null(std::false_type, variant_types<Types...>,
+                            Visitor &&visitor, Variant &&variant)
+    -> visit_result<Visitor&&, Variant&&, Types...>
+    {
+        assert(static_cast<bool>(variant) && "cannot return a value when visiting a null variant");
+        using result = visit_result<Visitor&&, Variant&&, Types...>;
+        return variant_visit_impl<result>(select_type<sizeof...(Types) <= max_inline_visit_types>(),
+                                          variant_types<Types...>(),
+                                          std::forward<Visitor>(visitor), std::forward<Variant>(variant));
+    }
+
+    template <typename ... Types, class Visitor, class Variant>
+    auto variant_visit(variant_types<Types...>, Visitor &&visitor, Variant &&variant)
+    -> visit_result<Visitor&&, Variant&&, Types...>
+    {
+        using result = visit_result<Visitor&&, Variant&&, Types...>;
+        return variant_visit_null(select_type<std::is_void<result>::value>(),
+                                  variant_types<Types...>(),
+                                  std::forward<Visitor>(visitor), std::forward<Variant>(variant));
+    }
+
+    // visitation of a variant that can never be null, the check is dropped entirely
+    template <typename ... Types, class Visitor, class Variant>
+    auto variant_visit_nonnull(variant_types<Types...>, Visitor &&visitor, Variant &&variant)
+    -> visit_result<Visitor&&, Variant&&, Types...>
+    {
+        using result = visit_result<Visitor&&, Variant&&, Types...>;
+        return variant_visit_impl<result>(select_type<sizeof...(Types) <= max_inline_visit_types>(),
+                                          variant_types<Types...>(),
+                                          std::forward<Visitor>(visitor), std::forward<Variant>(variant));
+    }
+
+    //=== multi visit implementation ===//
+    // C++14 std::index_sequence not available
+    template <std::size_t ... Is>
+    struct index_sequence {};
+
+    template <std::size_t N, std::size_t ... Is>
+    struct make_index_sequence_t : make_index_sequence_t<N - 1, N - 1, Is...> {};
+
+    template <std::size_t ... Is>
+    struct make_index_sequence_t<0, Is...>
+    {
+        using type = index_sequence<Is...>;
+    };
+
+    template <std::size_t N>
+    using make_index_sequence = typename make_index_sequence_t<N>::type;
+
+    template <class VariantTypes>
+    struct variant_types_size;
+
+    template <typename ... Types>
+    struct variant_types_size<variant_types<Types...>>
+    : std::integral_constant<std::size_t, sizeof...(Types)> {};
+
+    template <std::size_t I, class VariantTypes>
+    struct variant_types_at;
+
+    template <std::size_t I, typename ... Types>
+    struct variant_types_at<I, variant_types<Types...>> : type_at<I, Types...> {};
+
+    // the type list of a - possibly cv/ref qualified - variant
+    template <class Variant>
+    using variant_types_of = typename std::decay<Variant>::type::types;
+
+    // the flattened index is computed row-major:
+    // index = ((which_1 * size_2) + which_2) * size_3 + which_3 ...
+    constexpr std::size_t multi_product() noexcept
+    {
+        return 1u;
+    }
+
+    template <typename ... Sizes>
+    constexpr std::size_t multi_product(std::size_t head, Sizes ... tail) noexcept
+    {
+        return head * multi_product(tail...);
+    }
+
+    // the stride of the variant at a given position, i.e. the product of all following sizes
+    constexpr std::size_t multi_stride(std::size_t) noexcept
+    {
+        return 1u;
+    }
+
+    template <typename ... Sizes>
+    constexpr std::size_t multi_stride(std::size_t pos, std::size_t, Sizes ... tail) noexcept
+    {
+        return pos == 0u ? multi_product(tail...) : multi_stride(pos - 1u, tail...);
+    }
+
+    constexpr std::size_t multi_size_at(std::size_t) noexcept
+    {
+        return 1u;
+    }
+
+    template <typename ... Sizes>
+    constexpr std::size_t multi_size_at(std::size_t pos, std::size_t head, Sizes ... tail) noexcept
+    {
+        return pos == 0u ? head : multi_size_at(pos - 1u, tail...);
+    }
+
+    // extracts the which() value of the variant at position I from the flattened index K
+    template <std::size_t K, std::size_t I, class ... Variants>
+    struct multi_visit_digit
+    : std::integral_constant<std::size_t,
+        K / multi_stride(I, variant_types_size<variant_types_of<Variants>>::value...)
+          % multi_size_at(I, variant_types_size<variant_types_of<Variants>>::value...)> {};
+
+    inline std::size_t multi_visit_index(std::size_t idx) noexcept
+    {
+        return idx;
+    }
+
+    template <class Variant, class ... Variants>
+    std::size_t multi_visit_index(std::size_t idx, const Variant &head, const Variants&... tail) noexcept
+    {
+        return multi_visit_index(idx * variant_types_size<variant_types_of<Variant>>::value + head.which(),
+                                 tail...);
+    }
+
+    inline bool all_engaged() noexcept
+    {
+        return true;
+    }
+
+    template <class Variant, class ... Variants>
+    bool all_engaged(const Variant &head, const Variants&... tail) noexcept
+    {
+        return static_cast<bool>(head) && all_engaged(tail...);
+    }
+
+    // the result of a multi visitation,
+    // deduced from calling the visitor with the first type of each variant
+    template <class Visitor, class ... Variants>
+    using multi_visit_result = decltype(std::declval<Visitor>()(
+        get<typename variant_types_at<0u, variant_types_of<Variants>>::type>(
+            std::declval<Variants>())...));
+
+    template <typename R, std::size_t K, class Visitor, std::size_t ... Is, class ... Variants>
+    R call_multi_visitor_impl(index_sequence<Is...>, Visitor &&visitor, Variants&&... variants)
+    {
+        return static_cast<R>(std::forward<Visitor>(visitor)(
+            get<typename variant_types_at<multi_visit_digit<K, Is, Variants...>::value,
+                                          variant_types_of<Variants>>::type>(
+                std::forward<Variants>(variants))...));
+    }
+
+    template <typename R, std::size_t K, class Visitor, class ... Variants>
+    R call_multi_visitor(Visitor &&visitor, Variants&&... variants)
+    {
+        return call_multi_visitor_impl<R, K>(make_index_sequence<sizeof...(Variants)>(),
+                                             std::forward<Visitor>(visitor),
+                                             std::forward<Variants>(variants)...);
+    }
+
+    // the flattened function pointer table for a multi visitation,
+    // a static constant for the same reason as the single-variant visit_table:
+    // emitted once into .rodata instead of being rebuilt on every call
+    template <typename R, class Visitor, class KSequence, class ... Variants>
+    struct multi_visit_table;
+
+    template <typename R, class Visitor, std::size_t ... Ks, class ... Variants>
+    struct multi_visit_table<R, Visitor, index_sequence<Ks...>, Variants...>
+    {
+        using visit_fnc = R(*)(Visitor&&, Variants&&...);
+
+        static constexpr visit_fnc fncs[sizeof...(Ks)] = {&call_multi_visitor<R, Ks, Visitor, Variants...>...};
+    };
+
+    template <typename R, class Visitor, std::size_t ... Ks, class ... Variants>
+    constexpr typename multi_visit_table<R, Visitor, index_sequence<Ks...>, Variants...>::visit_fnc
+        multi_visit_table<R, Visitor, index_sequence<Ks...>, Variants...>::fncs[sizeof...(Ks)];
+
+    template <typename R, class Visitor, std::size_t ... Ks, class ... Variants>
+    R multi_visit_impl(index_sequence<Ks...>, Visitor &&visitor, Variants&&... variants)
+    {
+        return multi_visit_table<R, Visitor&&, index_sequence<Ks...>, Variants&&...>::fncs[
+                   multi_visit_index(0u, variants...)](std::forward<Visitor>(visitor),
+                                                       std::forward<Variants>(variants)...);
+    }
+
+    // void multi visitation, null variants are simply ignored
+    template <class Visitor, class ... Variants>
+    void multi_visit_null(std::true_type, Visitor &&visitor, Variants&&... variants)
+    {
+        if (!all_engaged(variants...))
+            return;
+
+        multi_visit_impl<void>(make_index_sequence<
+                                   multi_product(variant_types_size<variant_types_of<Variants>>::value...)>(),
+                               std::forward<Visitor>(visitor), std::forward<Variants>(variants)...);
+    }
+
+    // value returning multi visitation, no variant may be null
+    template <class Visitor, class ... Variants>
+    auto multi_visit_null(std::false_type, Visitor &&visitor, Variants&&... variants)
+    -> multi_visit_result<Visitor&&, Variants&&...>
+    {
+        assert(all_engaged(variants...) && "cannot return a value when visiting a null variant");
+        using result = multi_visit_result<Visitor&&, Variants&&...>;
+        return multi_visit_impl<result>(make_index_sequence<
+                                            multi_product(variant_types_size<variant_types_of<Variants>>::value...)>(),
+                                        std::forward<Visitor>(visitor), std::forward<Variants>(variants)...);
+    }
+
+    template <class Visitor, class ... Variants>
+    auto multi_visit(Visitor &&visitor, Variants&&... variants)
+    -> multi_visit_result<Visitor&&, Variants&&...>
+    {
+        using result = multi_visit_result<Visitor&&, Variants&&...>;
+        return multi_visit_null(select_type<std::is_void<result>::value>(),
+                                std::forward<Visitor>(visitor), std::forward<Variants>(variants)...);
     }
 
     //=== visitors ===//
@@ -137,6 +461,59 @@ namespace foonathan { namespace storage { namespace detail
         return {&storage};
     }
 
+    // both variants store an object, but of different types:
+    // the first payload is parked in a raw temporary sized for it,
+    // costing three moves with one dispatch per variant
+    // (the first payload moves twice, the second once)
+    // instead of the nine of the three full variant move cycles of std::swap;
+    // only the relocatable byte-swap path gets away with one relocation per payload
+    template <class Variant>
+    struct variant_cross_swap_inner
+    {
+        Variant *a, *b;
+
+        // moves b's payload over into the now null a and leaves b null
+        template <typename U>
+        void operator()(U &other)
+        {
+            emplace<U>(*a, std::move(other));
+            other.~U();
+            b->which_ = typename Variant::which_type(Variant::invalid_index);
+        }
+    };
+
+    template <class Variant>
+    struct variant_cross_swap_visitor
+    {
+        Variant *a, *b;
+
+        variant_cross_swap_visitor(Variant &a, Variant &b) noexcept
+        : a(&a), b(&b) {}
+
+        template <typename T>
+        void operator()(T &value)
+        {
+            storage<T> tmp;
+            emplace<T>(tmp, std::move(value));
+            value.~T();
+            a->which_ = typename Variant::which_type(Variant::invalid_index);
+
+            // need to qualify, the forward declared variant overloads shadow the raw storage one
+            auto stored = foonathan::storage::get<T>(tmp);
+            try
+            {
+                visit(*b, variant_cross_swap_inner<Variant>{a, b});
+                emplace<T>(*b, std::move(*stored));
+            }
+            catch (...)
+            {
+                stored->~T();
+                throw;
+            }
+            stored->~T();
+        }
+    };
+
     struct variant_destroy_visitor
     {
         template <typename T>
@@ -148,28 +525,33 @@ namespace foonathan { namespace storage { namespace detail
 
     struct variant_hash_visitor
     {
-        std::size_t hash;
-
         template <typename T>
-        void operator()(T &&arg)
+        std::size_t operator()(T &&arg) const
         {
-            hash = std::hash<typename std::decay<T>::type>()(std::forward<T>(arg));
+            return std::hash<typename std::decay<T>::type>()(std::forward<T>(arg));
         }
     };
 
+    // mixes the discriminant of a variant into the hash of its value,
+    // so equal values of different alternatives don't collide
+    constexpr std::size_t hash_mix(std::size_t which, std::size_t value_hash) noexcept
+    {
+        return value_hash ^ (which + std::size_t(0x9e3779b9u)
+                             + (value_hash << 6) + (value_hash >> 2));
+    }
+
     template <class Variant>
     struct variant_compare_visitor
     {
         const Variant *var;
-        bool equal;
 
         variant_compare_visitor(const Variant &var) noexcept
         : var(&var) {}
 
         template <typename T>
-        void operator()(const T &a)
+        bool operator()(const T &a) const
         {
-            equal = get<T>(*var) == a;
+            return get<T>(*var) == a;
         }
     };
 }}} // namespace foonathan::storage::detail
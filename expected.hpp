@@ -0,0 +1,373 @@
+// Copyright (C) 2014 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_STORAGE_EXPECTED_HPP_INCLUDED
+#define FOONATHAN_STORAGE_EXPECTED_HPP_INCLUDED
+
+#include <cassert>
+#include <functional>
+#include <type_traits>
+
+#include "raw_storage.hpp"
+
+namespace foonathan { namespace storage
+{
+    /// \brief Tag type to construct an \ref expected holding the error.
+    constexpr struct unexpect_t {} unexpect;
+
+    /// \brief Either a value or the error describing why there is none.
+    /// \detail It uses a \ref storage sized for both alternatives
+    /// plus a single-bit discriminant,
+    /// making it an error-carrying return type that does not need exceptions.
+    /// Unlike \ref optional it is never empty.
+    template <typename T, typename E>
+    class expected
+    {
+        static_assert(!std::is_reference<T>::value && !std::is_reference<E>::value,
+                      "can't store references");
+        using nothrow_move = std::integral_constant<bool,
+                std::is_nothrow_move_constructible<T>::value
+             && std::is_nothrow_move_constructible<E>::value>;
+    public:
+        //=== typedefs ===//
+        using value_type = T;
+        using error_type = E;
+
+        //=== constructors/destructor/assignment/swap ===//
+        /// \brief Creates an expected holding a default-constructed value.
+        expected()
+        : has_value_(true)
+        {
+            emplace<value_type>(storage_);
+        }
+
+        /// @{
+        /// \brief Initializes it with a value.
+        expected(const value_type &val)
+        : has_value_(true)
+        {
+            emplace<value_type>(storage_, val);
+        }
+
+        expected(value_type &&val) noexcept(std::is_nothrow_move_constructible<T>::value)
+        : has_value_(true)
+        {
+            emplace<value_type>(storage_, std::move(val));
+        }
+        /// @}
+
+        /// \brief Initializes it with an error constructed from the given arguments.
+        template <typename ... Args>
+        expected(unexpect_t, Args&&... args)
+        : has_value_(false)
+        {
+            emplace<error_type>(storage_, std::forward<Args>(args)...);
+        }
+
+        /// \brief Copy-constructs an expected by copying value or error.
+        expected(const expected &other)
+        : has_value_(other.has_value_)
+        {
+            if (other.has_value_)
+                emplace<value_type>(storage_, *other);
+            else
+                emplace<error_type>(storage_, other.error());
+        }
+
+        /// \brief Move-constructs an expected by moving value or error.
+        expected(expected &&other) noexcept(nothrow_move::value)
+        : has_value_(other.has_value_)
+        {
+            if (other.has_value_)
+                emplace<value_type>(storage_, std::move(*other));
+            else
+                emplace<error_type>(storage_, std::move(other.error()));
+        }
+
+        /// \brief Destroys value or error.
+        ~expected() noexcept
+        {
+            destroy();
+        }
+
+        /// \brief Copy-assigns another expected.
+        /// \detail It copies into a temporary first,
+        /// so a throwing copy constructor leaves this one untouched.
+        expected& operator=(const expected &other)
+        {
+            expected tmp(other);
+            *this = std::move(tmp);
+            return *this;
+        }
+
+        /// \brief Move-assigns another expected by moving value or error.
+        /// \detail Switching between value and error destroys the old member
+        /// before the new one is constructed,
+        /// so both move constructors must be \c noexcept -
+        /// there is no empty state a throwing one could leave behind.
+        expected& operator=(expected &&other) noexcept(nothrow_move::value)
+        {
+            static_assert(nothrow_move::value,
+                          "assignment can switch between value and error, "
+                          "which needs noexcept move constructors to keep the expected engaged");
+            if (has_value_ && other.has_value_)
+                **this = std::move(*other);
+            else if (!has_value_ && !other.has_value_)
+                error() = std::move(other.error());
+            else
+            {
+                destroy();
+                has_value_ = other.has_value_;
+                if (has_value_)
+                    emplace<value_type>(storage_, std::move(*other));
+                else
+                    emplace<error_type>(storage_, std::move(other.error()));
+            }
+            return *this;
+        }
+
+        /// @{
+        /// \brief Assigns a value.
+        expected& operator=(const value_type &val)
+        {
+            *this = expected(val);
+            return *this;
+        }
+
+        expected& operator=(value_type &&val) noexcept(std::is_nothrow_move_constructible<T>::value)
+        {
+            static_assert(std::is_nothrow_move_constructible<T>::value,
+                          "assigning over the error destroys it first, "
+                          "which needs a noexcept move constructor to keep the expected engaged");
+            if (has_value_)
+                **this = std::move(val);
+            else
+            {
+                destroy();
+                emplace<value_type>(storage_, std::move(val));
+                has_value_ = true;
+            }
+            return *this;
+        }
+        /// @}
+
+        /// \brief Swaps two expecteds.
+        friend void swap(expected &a, expected &b) noexcept(nothrow_move::value)
+        {
+            expected tmp(std::move(a));
+            a = std::move(b);
+            b = std::move(tmp);
+        }
+
+        //=== access ===//
+        /// @{
+        /// \brief Returns the stored value.
+        /// \note There must be a value stored, not an error.
+        value_type& operator*()
+        {
+            assert(has_value_ && "expected holds the error");
+            return *get<value_type>(storage_);
+        }
+
+        const value_type& operator*() const
+        {
+            assert(has_value_ && "expected holds the error");
+            return *get<value_type>(storage_);
+        }
+
+        value_type* operator->()
+        {
+            return &operator*();
+        }
+
+        const value_type* operator->() const
+        {
+            return &operator*();
+        }
+        /// @}
+
+        /// @{
+        /// \brief Returns the stored error.
+        /// \note There must be an error stored, not a value.
+        error_type& error()
+        {
+            assert(!has_value_ && "expected holds a value");
+            return *get<error_type>(storage_);
+        }
+
+        const error_type& error() const
+        {
+            assert(!has_value_ && "expected holds a value");
+            return *get<error_type>(storage_);
+        }
+        /// @}
+
+        /// \brief Returns \c true if there is a value stored, \c false if it is the error.
+        explicit operator bool() const noexcept
+        {
+            return has_value_;
+        }
+
+        //=== comparison ===//
+        /// @{
+        /// \brief Compares two expecteds for (in-)equality.
+        /// \detail They are equal if both store equal values or both store equal errors.
+        friend bool operator==(const expected &a, const expected &b)
+        {
+            if (a.has_value_ != b.has_value_)
+                return false;
+            return a.has_value_ ? *a == *b : a.error() == b.error();
+        }
+
+        friend bool operator!=(const expected &a, const expected &b)
+        {
+            return !(a == b);
+        }
+        /// @}
+
+        /// @{
+        /// \brief Compares an expected with a value.
+        friend bool operator==(const expected &a, const value_type &b)
+        {
+            return a && *a == b;
+        }
+
+        friend bool operator==(const value_type &a, const expected &b)
+        {
+            return b == a;
+        }
+
+        friend bool operator!=(const expected &a, const value_type &b)
+        {
+            return !(a == b);
+        }
+
+        friend bool operator!=(const value_type &a, const expected &b)
+        {
+            return !(b == a);
+        }
+        /// @}
+
+    private:
+        void destroy() noexcept
+        {
+            if (has_value_)
+                get<value_type>(storage_)->~value_type();
+            else
+                get<error_type>(storage_)->~error_type();
+        }
+
+        storage<value_type, error_type> storage_;
+        bool has_value_;
+    };
+
+    /// @{
+    /// \brief Returns the stored value of an \ref expected.
+    /// \detail This is the same as \ref expected::operator*().
+    /// \relates expected
+    template <typename T, typename E>
+    const T& get(const expected<T, E> &exp)
+    {
+        return *exp;
+    }
+
+    template <typename T, typename E>
+    T& get(expected<T, E> &exp)
+    {
+        return *exp;
+    }
+
+    template <typename T, typename E>
+    T&& get(expected<T, E> &&exp)
+    {
+        return std::move(*exp);
+    }
+    /// @}
+
+    /// \brief Tries to return a copy of the stored value inside an \ref expected.
+    /// \detail If it stores the error, it returns \c val.
+    /// \relates expected
+    template <typename T, typename E, typename U>
+    T try_get(const expected<T, E> &exp, U &&val)
+    {
+        if (exp)
+            return *exp;
+        return std::forward<U>(val);
+    }
+
+    /// @{
+    /// \brief Transforms the value of an \ref expected with a function.
+    /// \detail If it stores a value, the result stores the function applied to it,
+    /// otherwise the error is passed through unchanged.
+    /// \relates expected
+    template <typename T, typename E, class Func>
+    auto map(const expected<T, E> &exp, Func &&func)
+    -> expected<typename std::decay<decltype(func(*exp))>::type, E>
+    {
+        using result = expected<typename std::decay<decltype(func(*exp))>::type, E>;
+        if (exp)
+            return result(func(*exp));
+        return result(unexpect, exp.error());
+    }
+
+    template <typename T, typename E, class Func>
+    auto map(expected<T, E> &&exp, Func &&func)
+    -> expected<typename std::decay<decltype(func(std::move(*exp)))>::type, E>
+    {
+        using result = expected<typename std::decay<decltype(func(std::move(*exp)))>::type, E>;
+        if (exp)
+            return result(func(std::move(*exp)));
+        return result(unexpect, std::move(exp.error()));
+    }
+    /// @}
+
+    /// @{
+    /// \brief Chains an \ref expected with a function that itself can fail.
+    /// \detail The function must return an \ref expected with the same error type.
+    /// If this one stores a value, the result of the function is returned,
+    /// otherwise the error is passed through unchanged.
+    /// \relates expected
+    template <typename T, typename E, class Func>
+    auto and_then(const expected<T, E> &exp, Func &&func)
+    -> typename std::decay<decltype(func(*exp))>::type
+    {
+        using result = typename std::decay<decltype(func(*exp))>::type;
+        if (exp)
+            return func(*exp);
+        return result(unexpect, exp.error());
+    }
+
+    template <typename T, typename E, class Func>
+    auto and_then(expected<T, E> &&exp, Func &&func)
+    -> typename std::decay<decltype(func(std::move(*exp)))>::type
+    {
+        using result = typename std::decay<decltype(func(std::move(*exp)))>::type;
+        if (exp)
+            return func(std::move(*exp));
+        return result(unexpect, std::move(exp.error()));
+    }
+    /// @}
+}} // namespace foonathan::storage
+
+namespace std
+{
+    /// \brief Specialization of \c std::hash for \ref expected.
+    /// \detail It calls the hash function for the value if there is one,
+    /// otherwise it will return a special value.
+    template <typename T, typename E>
+    class hash<foonathan::storage::expected<T, E>>
+    {
+    public:
+        using argument_type = foonathan::storage::expected<T, E>;
+        using result_type = size_t;
+
+        result_type operator()(const argument_type &arg) const noexcept
+        {
+            return arg ? hash<T>()(*arg) :
+                  static_cast<result_type>(19937); // magic value
+        }
+    };
+} // namespace std
+
+#endif // FOONATHAN_STORAGE_EXPECTED_HPP_INCLUDED
@@ -0,0 +1,203 @@
+// Copyright (C) 2014 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_STORAGE_INPLACE_FUNCTION_HPP_INCLUDED
+#define FOONATHAN_STORAGE_INPLACE_FUNCTION_HPP_INCLUDED
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "raw_storage.hpp"
+
+namespace foonathan { namespace storage
+{
+    /// \brief A callable wrapper that stores the callable inline, never on the heap.
+    /// \detail Unlike \c std::function there is no allocation and no double indirection:
+    /// the callable lives in an embedded \c storage buffer of the given capacity
+    /// and a call dispatches through a single function pointer.
+    /// Callables that do not fit the capacity are rejected at compile-time
+    /// with the same \c sizeof/\c alignof constraints as the raw storage \ref emplace().
+    template <typename Signature, std::size_t Capacity = 4 * sizeof(void*)>
+    class inplace_function;
+
+    template <typename Result, typename ... Args, std::size_t Capacity>
+    class inplace_function<Result(Args...), Capacity>
+    {
+        using buffer_type = typename std::aligned_storage<Capacity>::type;
+    public:
+        //=== constructors/destructor/assignment ===//
+        /// @{
+        /// \brief Creates an empty function.
+        inplace_function() noexcept
+        : invoke_(nullptr), manage_(nullptr) {}
+
+        inplace_function(std::nullptr_t) noexcept
+        : inplace_function() {}
+        /// @}
+
+        /// \brief Creates a function storing a copy of the given callable inline.
+        /// \note The callable must fit into the capacity, this is checked at compile-time.
+        template <typename Functor,
+                  typename = typename std::enable_if<
+                      !std::is_same<typename std::decay<Functor>::type,
+                                    inplace_function>::value>::type>
+        inplace_function(Functor &&functor)
+        {
+            using functor_type = typename std::decay<Functor>::type;
+            static_assert(sizeof(functor_type) <= sizeof(buffer_type)
+                       && alignof(functor_type) <= alignof(buffer_type),
+                          "callable does not fit into the capacity");
+            static_assert(std::is_nothrow_move_constructible<functor_type>::value,
+                          "callable must not throw when moved");
+            emplace<functor_type>(buffer_, std::forward<Functor>(functor));
+            invoke_ = &invoke_functor<functor_type>;
+            manage_ = &manage_functor<functor_type>;
+        }
+
+        /// \brief Copy-constructs a function by copying the stored callable.
+        inplace_function(const inplace_function &other)
+        : invoke_(other.invoke_), manage_(other.manage_)
+        {
+            if (manage_)
+                manage_(operation::copy, &buffer_, &other.buffer_);
+        }
+
+        /// \brief Move-constructs a function by moving the stored callable.
+        /// \detail The other function is empty afterwards.
+        inplace_function(inplace_function &&other) noexcept
+        : invoke_(other.invoke_), manage_(other.manage_)
+        {
+            if (manage_)
+            {
+                manage_(operation::move, &buffer_, &other.buffer_);
+                manage_(operation::destroy, &other.buffer_, nullptr);
+                other.invoke_ = nullptr;
+                other.manage_ = nullptr;
+            }
+        }
+
+        /// \brief Destroys the stored callable - if any.
+        ~inplace_function() noexcept
+        {
+            if (manage_)
+                manage_(operation::destroy, &buffer_, nullptr);
+        }
+
+        /// @{
+        /// \brief Assigns a new callable or another function.
+        inplace_function& operator=(const inplace_function &other)
+        {
+            inplace_function copy(other);
+            *this = std::move(copy);
+            return *this;
+        }
+
+        inplace_function& operator=(inplace_function &&other) noexcept
+        {
+            if (this != &other)
+            {
+                *this = nullptr;
+                if (other.manage_)
+                {
+                    other.manage_(operation::move, &buffer_, &other.buffer_);
+                    invoke_ = other.invoke_;
+                    manage_ = other.manage_;
+                    other = nullptr;
+                }
+            }
+            return *this;
+        }
+
+        inplace_function& operator=(std::nullptr_t) noexcept
+        {
+            if (manage_)
+                manage_(operation::destroy, &buffer_, nullptr);
+            invoke_ = nullptr;
+            manage_ = nullptr;
+            return *this;
+        }
+        /// @}
+
+        //=== invocation ===//
+        /// \brief Calls the stored callable.
+        /// \detail There must be a callable stored.
+        Result operator()(Args... args) const
+        {
+            assert(invoke_ && "no callable stored");
+            return invoke_(&buffer_, std::forward<Args>(args)...);
+        }
+
+        /// \brief Returns \c true if there is a callable stored.
+        explicit operator bool() const noexcept
+        {
+            return invoke_ != nullptr;
+        }
+
+        //=== comparision ===//
+        /// @{
+        /// \brief Compares a function and \c nullptr.
+        friend bool operator==(const inplace_function &f, std::nullptr_t) noexcept
+        {
+            return !f;
+        }
+
+        friend bool operator==(std::nullptr_t, const inplace_function &f) noexcept
+        {
+            return !f;
+        }
+
+        friend bool operator!=(const inplace_function &f, std::nullptr_t) noexcept
+        {
+            return static_cast<bool>(f);
+        }
+
+        friend bool operator!=(std::nullptr_t, const inplace_function &f) noexcept
+        {
+            return static_cast<bool>(f);
+        }
+        /// @}
+
+    private:
+        enum class operation
+        {
+            copy,
+            move,
+            destroy
+        };
+
+        template <typename Functor>
+        static Result invoke_functor(const buffer_type *buffer, Args... args)
+        {
+            // the callable itself is not const, mirroring std::function
+            auto functor = get<Functor>(*const_cast<buffer_type*>(buffer));
+            return (*functor)(std::forward<Args>(args)...);
+        }
+
+        template <typename Functor>
+        static void manage_functor(operation op, buffer_type *dest, const buffer_type *src)
+        {
+            switch (op)
+            {
+            case operation::copy:
+                emplace<Functor>(*dest, *get<Functor>(*src));
+                break;
+            case operation::move:
+                emplace<Functor>(*dest,
+                                 std::move(*get<Functor>(*const_cast<buffer_type*>(src))));
+                break;
+            case operation::destroy:
+                get<Functor>(*dest)->~Functor();
+                break;
+            }
+        }
+
+        buffer_type buffer_;
+        Result (*invoke_)(const buffer_type *, Args...);
+        void (*manage_)(operation, buffer_type *, const buffer_type *);
+    };
+}} // namespace foonathan::storage
+
+#endif // FOONATHAN_STORAGE_INPLACE_FUNCTION_HPP_INCLUDED
@@ -0,0 +1,200 @@
+// Copyright (C) 2014 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_STORAGE_INPLACE_VECTOR_HPP_INCLUDED
+#define FOONATHAN_STORAGE_INPLACE_VECTOR_HPP_INCLUDED
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+
+#include "raw_algorithm.hpp"
+#include "raw_storage.hpp"
+
+namespace foonathan { namespace storage
+{
+    /// \brief A vector with fixed capacity that never allocates.
+    /// \detail All elements live in an embedded array of \ref storage slots,
+    /// so it can be used where a heap allocation is not acceptable.
+    /// Exceeding the capacity is a precondition violation, not a growth trigger.
+    /// Copy and move use the \ref storage algorithms,
+    /// so trivially copyable/relocatable types are transferred with a plain \c memcpy.
+    template <typename T, std::size_t N>
+    class inplace_vector
+    {
+        static_assert(!std::is_reference<T>::value, "can't store references");
+        static_assert(sizeof(storage<T>) == sizeof(T),
+                      "storage slots must be able to form a contiguous array of T");
+    public:
+        using value_type = T;
+        using iterator = T*;
+        using const_iterator = const T*;
+
+        //=== constructors/destructor/assignment ===//
+        /// \brief Creates an empty vector.
+        inplace_vector() noexcept
+        : size_(0u) {}
+
+        /// \brief Creates a vector with \c n copies of a value.
+        inplace_vector(std::size_t n, const T &value)
+        : size_(0u)
+        {
+            assert(n <= N && "capacity exceeded");
+            uninitialized_fill(buffer_, n, value);
+            size_ = n;
+        }
+
+        /// \brief Copy-constructs a vector by copying all elements.
+        inplace_vector(const inplace_vector &other)
+        : size_(0u)
+        {
+            for (std::size_t i = 0u; i != other.size_; ++i)
+                push_back(other[i]);
+        }
+
+        /// \brief Move-constructs a vector by relocating all elements.
+        /// \detail The other vector is empty afterwards;
+        /// for trivially relocatable types this is a single \c memcpy.
+        inplace_vector(inplace_vector &&other)
+        : size_(other.size_)
+        {
+            uninitialized_relocate<T>(other.buffer_, other.size_, buffer_);
+            other.size_ = 0u;
+        }
+
+        /// \brief Destroys all elements.
+        ~inplace_vector() noexcept
+        {
+            clear();
+        }
+
+        /// @{
+        /// \brief Assigns another vector.
+        inplace_vector& operator=(const inplace_vector &other)
+        {
+            inplace_vector copy(other);
+            *this = std::move(copy);
+            return *this;
+        }
+
+        inplace_vector& operator=(inplace_vector &&other)
+        {
+            clear();
+            uninitialized_relocate<T>(other.buffer_, other.size_, buffer_);
+            size_ = other.size_;
+            other.size_ = 0u;
+            return *this;
+        }
+        /// @}
+
+        //=== modifiers ===//
+        /// @{
+        /// \brief Appends an element.
+        /// \detail There must be capacity left.
+        void push_back(const T &value)
+        {
+            emplace_back(value);
+        }
+
+        void push_back(T &&value)
+        {
+            emplace_back(std::move(value));
+        }
+        /// @}
+
+        /// \brief Constructs an element directly at the end.
+        /// \detail There must be capacity left.
+        template <typename ... Args>
+        void emplace_back(Args&&... args)
+        {
+            assert(size_ < N && "capacity exceeded");
+            emplace<T>(buffer_[size_], std::forward<Args>(args)...);
+            ++size_;
+        }
+
+        /// \brief Destroys the last element.
+        void pop_back() noexcept
+        {
+            assert(size_ > 0u && "vector is empty");
+            --size_;
+            get<T>(buffer_[size_])->~T();
+        }
+
+        /// \brief Destroys all elements.
+        void clear() noexcept
+        {
+            destroy_n<T>(buffer_, size_);
+            size_ = 0u;
+        }
+
+        //=== accessors ===//
+        /// \brief Returns the number of elements.
+        std::size_t size() const noexcept
+        {
+            return size_;
+        }
+
+        /// \brief Returns the fixed capacity.
+        static constexpr std::size_t capacity() noexcept
+        {
+            return N;
+        }
+
+        /// \brief Returns \c true if there are no elements.
+        bool empty() const noexcept
+        {
+            return size_ == 0u;
+        }
+
+        /// @{
+        /// \brief Returns a reference to the element at the given position.
+        T& operator[](std::size_t i) noexcept
+        {
+            assert(i < size_ && "index out of range");
+            return *get<T>(buffer_[i]);
+        }
+
+        const T& operator[](std::size_t i) const noexcept
+        {
+            assert(i < size_ && "index out of range");
+            return *get<T>(buffer_[i]);
+        }
+        /// @}
+
+        /// @{
+        /// \brief Returns a reference to the first/last element.
+        T& front() noexcept { return (*this)[0u]; }
+        const T& front() const noexcept { return (*this)[0u]; }
+        T& back() noexcept { return (*this)[size_ - 1u]; }
+        const T& back() const noexcept { return (*this)[size_ - 1u]; }
+        /// @}
+
+        /// @{
+        /// \brief Returns a pointer to the contiguous elements.
+        T* data() noexcept
+        {
+            return get<T>(buffer_[0u]);
+        }
+
+        const T* data() const noexcept
+        {
+            return get<T>(buffer_[0u]);
+        }
+        /// @}
+
+        /// @{
+        /// \brief Iteration over the elements.
+        iterator begin() noexcept { return data(); }
+        const_iterator begin() const noexcept { return data(); }
+        iterator end() noexcept { return data() + size_; }
+        const_iterator end() const noexcept { return data() + size_; }
+        /// @}
+
+    private:
+        storage<T> buffer_[N];
+        std::size_t size_;
+    };
+}} // namespace foonathan::storage
+
+#endif // FOONATHAN_STORAGE_INPLACE_VECTOR_HPP_INCLUDED
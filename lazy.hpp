@@ -0,0 +1,177 @@
+// Copyright (C) 2014 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_STORAGE_LAZY_HPP_INCLUDED
+#define FOONATHAN_STORAGE_LAZY_HPP_INCLUDED
+
+#include <atomic>
+#include <cassert>
+#include <type_traits>
+
+#include "raw_storage.hpp"
+
+namespace foonathan { namespace storage
+{
+    /// \brief Concurrency policy for \ref lazy without any synchronization.
+    /// \detail The initialization check is a plain branch on a \c bool,
+    /// use it for objects only ever accessed from one thread.
+    class single_threaded
+    {
+    public:
+        bool is_initialized() const noexcept
+        {
+            return initialized_;
+        }
+
+        bool try_begin() noexcept
+        {
+            return !initialized_;
+        }
+
+        void done() noexcept
+        {
+            initialized_ = true;
+        }
+
+        void abort() noexcept {}
+
+        void wait_ready() const noexcept
+        {
+            assert(false && "concurrent initialization under the single_threaded policy");
+        }
+
+    private:
+        bool initialized_ = false;
+    };
+
+    /// \brief Concurrency policy for \ref lazy with double-checked atomic initialization.
+    /// \detail The fast path of an access is a single acquire load,
+    /// only the first accesses pay for the compare-exchange;
+    /// threads losing the race spin until the winner finished constructing.
+    class multi_threaded
+    {
+        enum state : unsigned char
+        {
+            empty,
+            constructing,
+            ready
+        };
+
+    public:
+        bool is_initialized() const noexcept
+        {
+            return state_.load(std::memory_order_acquire) == ready;
+        }
+
+        bool try_begin() noexcept
+        {
+            auto expected = static_cast<unsigned char>(empty);
+            return state_.compare_exchange_strong(expected, constructing,
+                                                  std::memory_order_acquire);
+        }
+
+        void done() noexcept
+        {
+            state_.store(ready, std::memory_order_release);
+        }
+
+        void abort() noexcept
+        {
+            state_.store(empty, std::memory_order_release);
+        }
+
+        void wait_ready() const noexcept
+        {
+            while (state_.load(std::memory_order_acquire) != ready)
+                ; // spin, construction is in progress on another thread
+        }
+
+    private:
+        std::atomic<unsigned char> state_{empty};
+    };
+
+    /// \brief An object whose construction is deferred to the first access.
+    /// \detail It uses \ref storage for the object and a concurrency policy for the guard,
+    /// avoiding the lock-prefixed check of \c std::call_once or function-local statics:
+    /// \ref single_threaded is a plain branch, \ref multi_threaded one acquire load.
+    template <typename T, class ConcurrencyPolicy = single_threaded>
+    class lazy
+    {
+        static_assert(!std::is_reference<T>::value, "can't store references");
+    public:
+        //=== typedefs ===//
+        using value_type = T;
+
+        //=== constructors/destructor ===//
+        /// \brief Creates a lazy without constructing the object.
+        lazy() noexcept = default;
+
+        lazy(const lazy &) = delete;
+        lazy& operator=(const lazy &) = delete;
+
+        /// \brief Destroys the object - if it was ever constructed.
+        ~lazy() noexcept
+        {
+            if (policy_.is_initialized())
+                get<value_type>(storage_)->~value_type();
+        }
+
+        //=== access ===//
+        /// \brief Returns the object, constructing it from the arguments on the first call.
+        /// \detail Arguments of later calls are ignored.
+        /// Under \ref multi_threaded, concurrent callers wait until construction finished.
+        template <typename ... Args>
+        value_type& value(Args&&... args)
+        {
+            if (!policy_.is_initialized())
+                initialize(std::forward<Args>(args)...);
+            return *get<value_type>(storage_);
+        }
+
+        /// @{
+        /// \brief Returns the object, default-constructing it on the first access.
+        value_type& operator*()
+        {
+            return value();
+        }
+
+        value_type* operator->()
+        {
+            return &value();
+        }
+        /// @}
+
+        /// \brief Returns \c true if the object was already constructed.
+        bool is_initialized() const noexcept
+        {
+            return policy_.is_initialized();
+        }
+
+    private:
+        template <typename ... Args>
+        void initialize(Args&&... args)
+        {
+            if (policy_.try_begin())
+            {
+                try
+                {
+                    emplace<value_type>(storage_, std::forward<Args>(args)...);
+                }
+                catch (...)
+                {
+                    policy_.abort();
+                    throw;
+                }
+                policy_.done();
+            }
+            else
+                policy_.wait_ready();
+        }
+
+        storage<value_type> storage_;
+        ConcurrencyPolicy policy_;
+    };
+}} // namespace foonathan::storage
+
+#endif // FOONATHAN_STORAGE_LAZY_HPP_INCLUDED
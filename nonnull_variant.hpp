@@ -0,0 +1,362 @@
+// Copyright (C) 2014 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_STORAGE_NONNULL_VARIANT_HPP_INCLUDED
+#define FOONATHAN_STORAGE_NONNULL_VARIANT_HPP_INCLUDED
+
+#include <cassert>
+#include <type_traits>
+
+#include "variant.hpp"
+
+namespace foonathan { namespace storage
+{
+    /// \brief A \ref variant that always contains a value.
+    /// \detail There is no null state:
+    /// the default constructor default-constructs the first type
+    /// and visitation dispatches without checking for null.
+    /// The discriminant only needs to cover the types themselves,
+    /// so its packing is as tight as possible.<br>
+    /// It provides the same core interface as \ref variant,
+    /// except for everything involving \ref nullvar.
+    template <typename ... Types>
+    class nonnull_variant
+    {
+        static_assert(sizeof...(Types) > 0u, "need at least one type");
+        static_assert(detail::valid_types<Types...>(), "can't store references");
+        using trivial = std::integral_constant<bool, detail::trivial_types<Types...>()>;
+        using relocatable = std::integral_constant<bool, detail::relocatable_types<Types...>()>;
+        using nothrow_move = std::integral_constant<bool, detail::nothrow_move_types<Types...>()>;
+        using which_type = detail::compact_index_t<sizeof...(Types) - 1>;
+        using first_type = typename detail::type_at<0, Types...>::type;
+    public:
+        //=== statics ===//
+        /// \brief Represents an invalid index of a type.
+        /// \detail It is only returned by type queries, the variant never stores it.
+        static constexpr auto invalid_index = sizeof...(Types);
+
+        /// \brief The types.
+        using types = variant_types<Types...>;
+
+        //=== constructors/destructor/assignment/swap ===//
+        /// \brief Creates a variant storing a default-constructed object of the first type.
+        nonnull_variant() noexcept(std::is_nothrow_default_constructible<first_type>::value)
+        : which_(which_type(0u))
+        {
+            emplace<first_type>(storage_);
+        }
+
+        /// \brief Initializes a variant with a value.
+        /// \note The type must be one of the types specified.
+        /// \see emplace() for a more sophisticated version.
+        template <typename T>
+        nonnull_variant(T &&val)
+        {
+            using t = typename std::decay<T>::type;
+            constexpr auto index = detail::get_index<t, Types...>();
+            static_assert(index != invalid_index,
+                          "type is not one of the types specified");
+            emplace<t>(storage_, std::forward<T>(val));
+            which_ = which_type(index);
+        }
+
+        /// \brief Copy-constructs a variant by copying the currently stored type.
+        nonnull_variant(const nonnull_variant &other)
+        {
+            construct(trivial(), other);
+        }
+
+        /// \brief Move-constructs a variant by moving the currently stored type.
+        /// \detail The other variant still contains a value of that type after the operation,
+        /// but a value that has been moved out - there is no null state it could be left in.
+        nonnull_variant(nonnull_variant &&other) noexcept(trivial::value || nothrow_move::value)
+        {
+            construct(trivial(), std::move(other));
+        }
+
+        /// \brief Destroys the currently stored value.
+        ~nonnull_variant() noexcept
+        {
+            if (!trivial::value)
+                visit(*this, detail::variant_destroy_visitor());
+        }
+
+        /// @{
+        /// \brief Assigns another variant by copying/moving the currently stored value.
+        /// \detail It just calls \ref emplace() passing the currently stored type.
+        nonnull_variant& operator=(const nonnull_variant &other)
+        {
+            if (trivial::value)
+                construct(std::true_type(), other);
+            else
+                visit(other, detail::variant_emplace_visitor(*this));
+            return *this;
+        }
+
+        nonnull_variant& operator=(nonnull_variant &&other) noexcept(trivial::value || nothrow_move::value)
+        {
+            if (trivial::value)
+                construct(std::true_type(), std::move(other));
+            else
+                visit(std::move(other), detail::variant_emplace_visitor(*this));
+            return *this;
+        }
+        /// @}
+
+        /// \brief Assigns a new value.
+        /// \note The type must be one of the types specified.
+        template <typename T>
+        nonnull_variant& operator=(T &&val)
+        {
+            using t = typename std::decay<T>::type;
+            emplace<t>(*this, std::forward<T>(val));
+            return *this;
+        }
+
+        /// \brief Swaps two variants.
+        /// \detail For trivial types the raw bytes are swapped directly.
+        /// Otherwise: if both variants contain the same type, the swap for that type is called,
+        /// else the values are rotated through a temporary variant,
+        /// keeping the always-engaged invariant at every step.
+        friend void swap(nonnull_variant &a, nonnull_variant &b) noexcept(trivial::value || nothrow_move::value)
+        {
+            if (trivial::value)
+            {
+                std::swap(a.storage_, b.storage_);
+                std::swap(a.which_, b.which_);
+            }
+            else if (a.which() == b.which())
+                visit(b, detail::variant_swap_visitor(a));
+            else
+            {
+                nonnull_variant tmp(std::move(a));
+                a = std::move(b);
+                b = std::move(tmp);
+            }
+        }
+
+        //=== accessors ===//
+        /// \brief Returns the index of the type of the currently stored inside the variant.
+        std::size_t which() const noexcept
+        {
+            return which_;
+        }
+
+        //=== comparision ===//
+        /// @{
+        /// \brief Compares two variants for (in-)equality.
+        /// \detail They are equal, if they store the same object.
+        friend bool operator==(const nonnull_variant &a, const nonnull_variant &b)
+        {
+            if (a.which() == b.which())
+                return visit(b, detail::variant_compare_visitor<nonnull_variant>(a));
+            return false;
+        }
+
+        friend bool operator!=(const nonnull_variant &a, const nonnull_variant &b)
+        {
+            return !(a == b);
+        }
+        /// @}
+
+    private:
+        // trivial types only
+        template <class Variant>
+        void construct(std::true_type, Variant &&other) noexcept
+        {
+            storage_ = other.storage_;
+            which_ = other.which_;
+        }
+
+        // non-trivial type
+        template <class Variant>
+        void construct(std::false_type, Variant &&other)
+        {
+            visit(std::forward<Variant>(other), detail::variant_emplace_visitor(storage_));
+            which_ = which_type(other.which());
+        }
+
+        // single argument that can be assigned
+        template <typename T, typename U>
+        void assign(U &&u,
+                    decltype(std::declval<T&>() = std::forward<U>(u), int()) = 0)
+        {
+            get<T>(*this) = std::forward<U>(u);
+        }
+
+        // multiple arguments or single one that can't be assigned directly
+        template <typename T, typename ... Args>
+        void assign(Args&&... args)
+        {
+            get<T>(*this) = T(std::forward<Args>(args)...);
+        }
+
+        // create temporary and move in because constructor can throw and move does not
+        template <typename T, typename ... Args>
+        void emplace_impl(std::true_type, Args&&... args)
+        {
+            emplace_relocate<T>(relocatable(), std::forward<Args>(args)...);
+        }
+
+        // relocatable: construct into a temporary raw storage and move the bytes over
+        template <typename T, typename ... Args>
+        void emplace_relocate(std::true_type, Args&&... args)
+        {
+            storage<Types...> tmp;
+            emplace<T>(tmp, std::forward<Args>(args)...);
+            visit(*this, detail::variant_destroy_visitor());
+            storage_ = tmp; // ownership of the value is transferred
+        }
+
+        template <typename T, typename ... Args>
+        void emplace_relocate(std::false_type, Args&&... args)
+        {
+            T tmp(std::forward<Args>(args)...);
+            visit(*this, detail::variant_destroy_visitor());
+            emplace<T>(storage_, std::move(tmp));
+        }
+
+        // emplace directly, construction must not throw:
+        // the old value is already destroyed at that point
+        // and there is no null state the variant could fall back to
+        template <typename T, typename ... Args>
+        void emplace_impl(std::false_type, Args&&... args)
+        {
+            static_assert(noexcept(T(std::forward<Args>(args)...))
+                       || relocatable::value
+                       || std::is_nothrow_move_constructible<T>::value,
+                          "cross-type emplace of a type whose construction can throw "
+                          "needs a non-throwing way back from the temporary, "
+                          "i.e. trivial relocation or a noexcept move constructor");
+            visit(*this, detail::variant_destroy_visitor());
+            emplace<T>(storage_, std::forward<Args>(args)...);
+        }
+
+        storage<Types...> storage_;
+        which_type which_;
+
+        template <typename T, typename ... UTypes, typename ... Args>
+        friend void emplace(nonnull_variant<UTypes...> &var, Args&&... args);
+        template <typename T, typename ... UTypes>
+        friend const T& get(const nonnull_variant<UTypes...> &var);
+    };
+
+    /// \brief Whether or not a \ref nonnull_variant currently contains an object of specific type.
+    /// \relates nonnull_variant
+    template <typename T, typename ... Types>
+    bool contains(const nonnull_variant<Types...> &var) noexcept
+    {
+        return var.which() == detail::get_index<T, Types...>();
+    }
+
+    /// \brief Emplaces a new object inside a \ref nonnull_variant.
+    /// \detail The same as for \ref variant, except that there never is a null state to fill:
+    /// if the type is already stored it assigns,
+    /// otherwise the old object is destroyed and the new one constructed,
+    /// going over a temporary when the construction can throw.
+    /// The temporary only helps when it can be moved in without throwing,
+    /// i.e. when the types are \ref is_trivially_relocatable
+    /// or the move constructor is \c noexcept;
+    /// a cross-type emplace that could strand the variant without a value
+    /// is rejected at compile time.
+    /// \note The type must be one of the types specified.
+    /// \relates nonnull_variant
+    template <typename T, typename ... Types, typename ... Args>
+    void emplace(nonnull_variant<Types...> &var, Args&&... args)
+    {
+        using t = typename std::decay<T>::type;
+        constexpr auto index = detail::get_index<t, Types...>();
+        static_assert(index != nonnull_variant<Types...>::invalid_index,
+                     "type is not one of the types specified");
+        if (nonnull_variant<Types...>::trivial::value)
+            emplace<t>(var.storage_, std::forward<Args>(args)...);
+        else if (index == var.which_)
+            var.template assign<t>(std::forward<Args>(args)...);
+        else
+            var.template emplace_impl<t>(std::integral_constant<bool,
+                                         !noexcept(T(std::forward<Args>(args)...))
+                                         && (nonnull_variant<Types...>::relocatable::value
+                                             || std::is_nothrow_move_constructible<T>::value)>{},
+                                         std::forward<Args>(args)...);
+        var.which_ = typename nonnull_variant<Types...>::which_type(index);
+    }
+
+    /// @{
+    /// \brief Returns a reference to the object currently stored.
+    /// \detail You have to specify the type explicitly and it must be currently stored.
+    /// \relates nonnull_variant
+    template <typename T, typename ... Types>
+    const T& get(const nonnull_variant<Types...> &var)
+    {
+        assert((var.which() == detail::get_index<T, Types...>())
+            && "type not currently stored inside the variant");
+        return *get<T>(var.storage_);
+    }
+
+    template <typename T, typename ... Types>
+    T& get(nonnull_variant<Types...> &var)
+    {
+        const nonnull_variant<Types...> &cvar = var;
+        return const_cast<T&>(get<T>(cvar));
+    }
+
+    template <typename T, typename ... Types>
+    T&& get(nonnull_variant<Types...> &&var)
+    {
+        return std::move(get<T>(var));
+    }
+    /// @}
+
+    /// @{
+    /// \brief Visits a \ref nonnull_variant.
+    /// \detail The same as for \ref variant,
+    /// except that the dispatch does not check for null - there is nothing to check.
+    /// \relates nonnull_variant
+    template <class Visitor, typename ... Types>
+    auto visit(const nonnull_variant<Types...> &var, Visitor &&visitor)
+    -> detail::visit_result<Visitor&&, const nonnull_variant<Types...>&, Types...>
+    {
+        return detail::variant_visit_nonnull(variant_types<Types...>(),
+                                             std::forward<Visitor>(visitor), var);
+    }
+
+    template <class Visitor, typename ... Types>
+    auto visit(nonnull_variant<Types...> &var, Visitor &&visitor)
+    -> detail::visit_result<Visitor&&, nonnull_variant<Types...>&, Types...>
+    {
+        return detail::variant_visit_nonnull(variant_types<Types...>(),
+                                             std::forward<Visitor>(visitor), var);
+    }
+
+    template <class Visitor, typename ... Types>
+    auto visit(nonnull_variant<Types...> &&var, Visitor &&visitor)
+    -> detail::visit_result<Visitor&&, nonnull_variant<Types...>&&, Types...>
+    {
+        return detail::variant_visit_nonnull(variant_types<Types...>(),
+                                             std::forward<Visitor>(visitor), std::move(var));
+    }
+    /// @}
+}} // namespace foonathan::storage
+
+namespace std
+{
+    /// \brief Specialization of \c std::hash for \ref nonnull_variant.
+    /// \detail Consistent with the specialization for \ref variant,
+    /// except that there never is a null state to map to a special value.
+    template <typename ... Types>
+    class hash<foonathan::storage::nonnull_variant<Types...>>
+    {
+    public:
+        using argument_type = foonathan::storage::nonnull_variant<Types...>;
+        using result_type = size_t;
+
+        result_type operator()(const argument_type &arg) const noexcept
+        {
+            return foonathan::storage::detail::hash_mix(arg.which(),
+                       visit(arg, foonathan::storage::detail::variant_hash_visitor()));
+        }
+    };
+} // namespace std
+
+#endif // FOONATHAN_STORAGE_NONNULL_VARIANT_HPP_INCLUDED
@@ -0,0 +1,151 @@
+// Copyright (C) 2014 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_STORAGE_OFFSET_PTR_HPP_INCLUDED
+#define FOONATHAN_STORAGE_OFFSET_PTR_HPP_INCLUDED
+
+#include <cassert>
+#include <cstddef>
+
+#include "pointer_cast.hpp"
+
+namespace foonathan { namespace storage
+{
+    /// \brief A pointer that stays valid when its surrounding memory region is mapped elsewhere.
+    /// \detail Instead of an address it stores the distance to the pointee,
+    /// so objects placed together in e.g. a POSIX shared memory segment
+    /// can reference each other across processes mapping the segment at different bases.
+    /// Pointer and pointee must always be moved together for that to hold.
+    /// \note It cannot point to itself, that distance represents the null pointer.
+    template <typename T>
+    class offset_ptr
+    {
+    public:
+        //=== typedefs ===//
+        using element_type = T;
+
+        //=== constructors/assignment ===//
+        /// @{
+        /// \brief Creates a null pointer.
+        offset_ptr() noexcept
+        : offset_(0) {}
+
+        offset_ptr(std::nullptr_t) noexcept
+        : offset_ptr() {}
+        /// @}
+
+        /// \brief Creates a pointer to an object in the same region.
+        offset_ptr(T *ptr) noexcept
+        : offset_(distance_to(ptr)) {}
+
+        /// \brief Copies a pointer; the copy points to the same object.
+        /// \detail The stored distance is recomputed, it is relative to this object.
+        offset_ptr(const offset_ptr &other) noexcept
+        : offset_(distance_to(other.get())) {}
+
+        /// @{
+        /// \brief Assigns another pointer or object.
+        offset_ptr& operator=(const offset_ptr &other) noexcept
+        {
+            offset_ = distance_to(other.get());
+            return *this;
+        }
+
+        offset_ptr& operator=(T *ptr) noexcept
+        {
+            offset_ = distance_to(ptr);
+            return *this;
+        }
+
+        offset_ptr& operator=(std::nullptr_t) noexcept
+        {
+            offset_ = 0;
+            return *this;
+        }
+        /// @}
+
+        //=== access ===//
+        /// \brief Returns the raw pointer valid in the current mapping.
+        T* get() const noexcept
+        {
+            if (offset_ == 0)
+                return nullptr;
+            auto base = const_cast<char*>(reinterpret_cast<const char*>(this));
+            return pointer_cast<T>(base + offset_);
+        }
+
+        /// @{
+        /// \brief Dereferences the pointer.
+        /// \note It must not be null.
+        T& operator*() const noexcept
+        {
+            assert(offset_ != 0 && "offset_ptr must not be null");
+            return *get();
+        }
+
+        T* operator->() const noexcept
+        {
+            return &operator*();
+        }
+        /// @}
+
+        /// \brief Returns \c true if the pointer is not null.
+        explicit operator bool() const noexcept
+        {
+            return offset_ != 0;
+        }
+
+        //=== comparision ===//
+        /// @{
+        /// \brief Compares two pointers; they are equal if they point to the same object.
+        friend bool operator==(const offset_ptr &a, const offset_ptr &b) noexcept
+        {
+            return a.get() == b.get();
+        }
+
+        friend bool operator!=(const offset_ptr &a, const offset_ptr &b) noexcept
+        {
+            return !(a == b);
+        }
+        /// @}
+
+        /// @{
+        /// \brief Compares a pointer and \c nullptr.
+        friend bool operator==(const offset_ptr &a, std::nullptr_t) noexcept
+        {
+            return !a;
+        }
+
+        friend bool operator==(std::nullptr_t, const offset_ptr &b) noexcept
+        {
+            return !b;
+        }
+
+        friend bool operator!=(const offset_ptr &a, std::nullptr_t) noexcept
+        {
+            return static_cast<bool>(a);
+        }
+
+        friend bool operator!=(std::nullptr_t, const offset_ptr &b) noexcept
+        {
+            return static_cast<bool>(b);
+        }
+        /// @}
+
+    private:
+        std::ptrdiff_t distance_to(T *ptr) const noexcept
+        {
+            if (!ptr)
+                return 0;
+            auto diff = reinterpret_cast<const char*>(ptr)
+                      - reinterpret_cast<const char*>(this);
+            assert(diff != 0 && "offset_ptr cannot point to itself");
+            return diff;
+        }
+
+        std::ptrdiff_t offset_;
+    };
+}} // namespace foonathan::storage
+
+#endif // FOONATHAN_STORAGE_OFFSET_PTR_HPP_INCLUDED
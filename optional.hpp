@@ -6,8 +6,10 @@
 #define FOONATHAN_STORAGE_OPTIONAL_HPP_INCLUDED
 
 #include <cassert>
+#include <functional>
 #include <type_traits>
 
+#include "detail/instrumentation.hpp"
 #include "raw_storage.hpp"
 
 namespace foonathan { namespace storage
@@ -42,7 +44,7 @@ namespace foonathan { namespace storage
         optional(const value_type &val)
         : null_(false)
         {
-            emplace(storage_, val);
+            emplace<value_type>(storage_, val);
         }
 
         optional(value_type &&val) noexcept(nothrow_move::value)
@@ -125,15 +127,20 @@ namespace foonathan { namespace storage
         {
             using std::swap;
             if (a && b)
+            {
+                FOONATHAN_STORAGE_COUNT_OPERATION(value_type, swap_value);
                 swap(*a, *b);
+            }
             else if (a && !b)
             {
+                FOONATHAN_STORAGE_COUNT_OPERATION(value_type, swap_move);
                 emplace<value_type>(b.storage_, std::move(*a));
                 b.null_ = false;
                 a = nullopt;
             }
             else if (b && !a)
             {
+                FOONATHAN_STORAGE_COUNT_OPERATION(value_type, swap_move);
                 emplace<value_type>(a.storage_, std::move(*b));
                 a.null_ = false;
                 b = nullopt;
@@ -276,9 +283,15 @@ namespace foonathan { namespace storage
     void emplace(optional<T> &opt, Args&&... args)
     {
         if (opt)
+        {
+            FOONATHAN_STORAGE_COUNT_OPERATION(T, emplace_assign);
             opt.assign(std::forward<Args>(args)...);
+        }
         else
+        {
+            FOONATHAN_STORAGE_COUNT_OPERATION(T, emplace_construct);
             emplace<T>(opt.storage_, std::forward<Args>(args)...);
+        }
         opt.null_ = false;
     }
 
@@ -342,6 +355,110 @@ namespace foonathan { namespace storage
             std::forward<Visitor>(visitor)(get<T>(std::move(opt)));
     }
     /// @}
+
+    namespace detail
+    {
+        template <typename T>
+        struct is_optional : std::false_type {};
+
+        template <typename T>
+        struct is_optional<foonathan::storage::optional<T>> : std::true_type {};
+    } // namespace detail
+
+    /// @{
+    /// \brief Applies a function to the stored value - if any.
+    /// \detail Returns an \ref optional of the function's result type:
+    /// the result of calling it with the stored value if there is one, null otherwise.
+    /// The value is threaded through by reference,
+    /// so a chain of calls tests each null flag once and copies no intermediates.
+    /// \relates optional
+    template <typename T, typename Func>
+    auto map(const optional<T> &opt, Func &&func)
+    -> optional<typename std::decay<decltype(func(*opt))>::type>
+    {
+        if (opt)
+            return std::forward<Func>(func)(*opt);
+        return nullopt;
+    }
+
+    template <typename T, typename Func>
+    auto map(optional<T> &opt, Func &&func)
+    -> optional<typename std::decay<decltype(func(*opt))>::type>
+    {
+        if (opt)
+            return std::forward<Func>(func)(*opt);
+        return nullopt;
+    }
+
+    template <typename T, typename Func>
+    auto map(optional<T> &&opt, Func &&func)
+    -> optional<typename std::decay<decltype(func(std::move(*opt)))>::type>
+    {
+        if (opt)
+            return std::forward<Func>(func)(std::move(*opt));
+        return nullopt;
+    }
+    /// @}
+
+    /// @{
+    /// \brief Applies a function returning an \ref optional to the stored value - if any.
+    /// \detail The same as \ref map(), except that the function itself returns an \ref optional
+    /// which is passed through unchanged, avoiding a nested <tt>optional<optional<U>></tt>.
+    /// \relates optional
+    template <typename T, typename Func>
+    auto and_then(const optional<T> &opt, Func &&func)
+    -> typename std::decay<decltype(func(*opt))>::type
+    {
+        static_assert(detail::is_optional<typename std::decay<decltype(func(*opt))>::type>::value,
+                      "function must return an optional");
+        if (opt)
+            return std::forward<Func>(func)(*opt);
+        return nullopt;
+    }
+
+    template <typename T, typename Func>
+    auto and_then(optional<T> &opt, Func &&func)
+    -> typename std::decay<decltype(func(*opt))>::type
+    {
+        static_assert(detail::is_optional<typename std::decay<decltype(func(*opt))>::type>::value,
+                      "function must return an optional");
+        if (opt)
+            return std::forward<Func>(func)(*opt);
+        return nullopt;
+    }
+
+    template <typename T, typename Func>
+    auto and_then(optional<T> &&opt, Func &&func)
+    -> typename std::decay<decltype(func(std::move(*opt)))>::type
+    {
+        static_assert(detail::is_optional<typename std::decay<decltype(func(std::move(*opt)))>::type>::value,
+                      "function must return an optional");
+        if (opt)
+            return std::forward<Func>(func)(std::move(*opt));
+        return nullopt;
+    }
+    /// @}
+
+    /// @{
+    /// \brief Returns the optional itself if it stores a value,
+    /// otherwise the \ref optional returned by the function.
+    /// \relates optional
+    template <typename T, typename Func>
+    optional<T> or_else(const optional<T> &opt, Func &&func)
+    {
+        if (opt)
+            return opt;
+        return std::forward<Func>(func)();
+    }
+
+    template <typename T, typename Func>
+    optional<T> or_else(optional<T> &&opt, Func &&func)
+    {
+        if (opt)
+            return std::move(opt);
+        return std::forward<Func>(func)();
+    }
+    /// @}
 }} // namespace foonathan::storage
 
 namespace std
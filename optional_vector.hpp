@@ -0,0 +1,281 @@
+// Copyright (C) 2014 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_STORAGE_OPTIONAL_VECTOR_HPP_INCLUDED
+#define FOONATHAN_STORAGE_OPTIONAL_VECTOR_HPP_INCLUDED
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "optional.hpp"
+#include "raw_storage.hpp"
+
+namespace foonathan { namespace storage
+{
+    /// \brief A sequence of optional values stored as a value column plus a presence bitmap.
+    /// \detail A \c std::vector of \ref optional interleaves the presence flag
+    /// (and its padding) with every value, halving the effective bandwidth of a scan.
+    /// This container keeps all values in one contiguous array of \ref storage
+    /// and the presence bits packed into 64-bit words,
+    /// so the bulk operations \ref count_present() and \ref for_each_present()
+    /// can skip 64 absent elements with a single word test.
+    /// \note The type must be \ref is_trivially_relocatable:
+    /// growing the value column relocates the present values by copying their bytes.
+    template <typename T>
+    class optional_vector
+    {
+        static_assert(!std::is_reference<T>::value, "can't store references");
+        static_assert(is_trivially_relocatable<T>::value,
+                      "type must be trivially relocatable, growth relocates the values by copying bytes");
+    public:
+        //=== constructors/destructor/assignment ===//
+        /// \brief Creates an empty vector.
+        optional_vector() noexcept = default;
+
+        /// \brief Copy-constructs a vector by copying the present values.
+        optional_vector(const optional_vector &other)
+        : values_(other.values_.size()), presence_(other.presence_)
+        {
+            std::size_t i = 0u;
+            try
+            {
+                for (; i != other.values_.size(); ++i)
+                    if (other.has_value(i))
+                        emplace<T>(values_[i], *get<T>(other.values_[i]));
+            }
+            catch (...)
+            {
+                // roll back the already copied values
+                for (std::size_t j = 0u; j != i; ++j)
+                    if (other.has_value(j))
+                        get<T>(values_[j])->~T();
+                throw;
+            }
+        }
+
+        /// \brief Move-constructs a vector by stealing the buffers.
+        /// \detail The other vector is empty afterwards.
+        optional_vector(optional_vector &&other) noexcept
+        : values_(std::move(other.values_)), presence_(std::move(other.presence_))
+        {
+            other.values_.clear();
+            other.presence_.clear();
+        }
+
+        /// \brief Destroys all present values.
+        ~optional_vector() noexcept
+        {
+            clear();
+        }
+
+        /// @{
+        /// \brief Assigns another vector.
+        optional_vector& operator=(const optional_vector &other)
+        {
+            optional_vector copy(other);
+            *this = std::move(copy);
+            return *this;
+        }
+
+        optional_vector& operator=(optional_vector &&other) noexcept
+        {
+            clear();
+            values_ = std::move(other.values_);
+            presence_ = std::move(other.presence_);
+            other.values_.clear();
+            other.presence_.clear();
+            return *this;
+        }
+        /// @}
+
+        //=== modifiers ===//
+        /// @{
+        /// \brief Appends a value or an absent element.
+        void push_back(const T &val)
+        {
+            emplace_back(val);
+        }
+
+        void push_back(T &&val)
+        {
+            emplace_back(std::move(val));
+        }
+
+        void push_back(nullopt_t)
+        {
+            values_.emplace_back();
+            grow_presence();
+        }
+        /// @}
+
+        /// \brief Appends a value constructed directly inside the column.
+        /// \detail The presence bitmap is extended before the value is constructed,
+        /// so a throwing constructor leaves a consistent absent element behind,
+        /// as if \c push_back(nullopt) had been called.
+        template <typename ... Args>
+        void emplace_back(Args&&... args)
+        {
+            values_.emplace_back();
+            grow_presence();
+            emplace<T>(values_.back(), std::forward<Args>(args)...);
+            set_bit(values_.size() - 1u);
+        }
+
+        /// @{
+        /// \brief Makes the element at the given position present/absent.
+        template <typename ... Args>
+        void emplace_at(std::size_t i, Args&&... args)
+        {
+            reset(i);
+            emplace<T>(values_[i], std::forward<Args>(args)...);
+            set_bit(i);
+        }
+
+        void reset(std::size_t i) noexcept
+        {
+            if (has_value(i))
+            {
+                get<T>(values_[i])->~T();
+                presence_[i / word_bits] &= ~(std::uint64_t(1) << (i % word_bits));
+            }
+        }
+        /// @}
+
+        /// \brief Destroys all present values and removes all elements.
+        void clear() noexcept
+        {
+            for_each_present([](T &val)
+                             {
+                                 val.~T();
+                             });
+            values_.clear();
+            presence_.clear();
+        }
+
+        /// \brief Reserves space for elements.
+        void reserve(std::size_t n)
+        {
+            values_.reserve(n);
+            presence_.reserve((n + word_bits - 1u) / word_bits);
+        }
+
+        //=== accessors ===//
+        /// \brief Returns the number of elements, present or not.
+        std::size_t size() const noexcept
+        {
+            return values_.size();
+        }
+
+        /// \brief Returns \c true if there are no elements.
+        bool empty() const noexcept
+        {
+            return values_.empty();
+        }
+
+        /// \brief Returns \c true if the element at the given position is present.
+        bool has_value(std::size_t i) const noexcept
+        {
+            return (presence_[i / word_bits] >> (i % word_bits)) & 1u;
+        }
+
+        /// @{
+        /// \brief Returns a reference to the value at the given position.
+        /// \detail The element must be present.
+        const T& get_value(std::size_t i) const
+        {
+            assert(has_value(i) && "element not present");
+            return *get<T>(values_[i]);
+        }
+
+        T& get_value(std::size_t i)
+        {
+            assert(has_value(i) && "element not present");
+            return *get<T>(values_[i]);
+        }
+        /// @}
+
+        /// \brief Returns the value at the given position or a replacement if absent.
+        T try_get_value(std::size_t i, T val) const
+        {
+            return has_value(i) ? *get<T>(values_[i]) : std::move(val);
+        }
+
+        //=== bulk operations ===//
+        /// \brief Returns the number of present elements.
+        /// \detail Counts an entire word of 64 presence bits at a time.
+        std::size_t count_present() const noexcept
+        {
+            std::size_t count = 0u;
+            for (auto word : presence_)
+                count += popcount(word);
+            return count;
+        }
+
+        /// @{
+        /// \brief Calls a visitor for every present value, in order.
+        /// \detail Mirrors the \ref visit() free function of \ref optional,
+        /// but a word with no bits set skips 64 absent elements with one test.
+        template <class Visitor>
+        void for_each_present(Visitor &&visitor)
+        {
+            for (std::size_t w = 0u; w != presence_.size(); ++w)
+                for (auto word = presence_[w]; word != 0u; word &= word - 1u)
+                    visitor(*get<T>(values_[w * word_bits + lowest_bit(word)]));
+        }
+
+        template <class Visitor>
+        void for_each_present(Visitor &&visitor) const
+        {
+            for (std::size_t w = 0u; w != presence_.size(); ++w)
+                for (auto word = presence_[w]; word != 0u; word &= word - 1u)
+                    visitor(*get<T>(values_[w * word_bits + lowest_bit(word)]));
+        }
+        /// @}
+
+    private:
+        static constexpr std::size_t word_bits = 64u;
+
+        static std::size_t popcount(std::uint64_t word) noexcept
+        {
+        #if defined(__GNUC__)
+            return std::size_t(__builtin_popcountll(word));
+        #else
+            std::size_t count = 0u;
+            for (; word != 0u; word &= word - 1u)
+                ++count;
+            return count;
+        #endif
+        }
+
+        // index of the lowest bit set, word must not be zero
+        static std::size_t lowest_bit(std::uint64_t word) noexcept
+        {
+        #if defined(__GNUC__)
+            return std::size_t(__builtin_ctzll(word));
+        #else
+            std::size_t i = 0u;
+            for (; (word & 1u) == 0u; word >>= 1)
+                ++i;
+            return i;
+        #endif
+        }
+
+        void grow_presence()
+        {
+            if (values_.size() > presence_.size() * word_bits)
+                presence_.push_back(0u);
+        }
+
+        void set_bit(std::size_t i) noexcept
+        {
+            presence_[i / word_bits] |= std::uint64_t(1) << (i % word_bits);
+        }
+
+        std::vector<storage<T>> values_;
+        std::vector<std::uint64_t> presence_;
+    };
+}} // namespace foonathan::storage
+
+#endif // FOONATHAN_STORAGE_OPTIONAL_VECTOR_HPP_INCLUDED
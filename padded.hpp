@@ -0,0 +1,95 @@
+// Copyright (C) 2014 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_STORAGE_PADDED_HPP_INCLUDED
+#define FOONATHAN_STORAGE_PADDED_HPP_INCLUDED
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace foonathan { namespace storage
+{
+    namespace detail
+    {
+        // the first type of a pack, void if it is empty
+        template <typename ... Args>
+        struct first_of
+        {
+            using type = void;
+        };
+
+        template <typename Head, typename ... Tail>
+        struct first_of<Head, Tail...>
+        {
+            using type = Head;
+        };
+    } // namespace detail
+
+    /// \brief A typical cache line size, for use as alignment of \ref padded.
+    constexpr std::size_t cache_line_size = 64u;
+
+    /// \brief Wraps an object to raise its alignment and pad it to that alignment.
+    /// \detail \ref optional and \ref variant always use the natural alignment of their types;
+    /// wrapping an instance gives it e.g. a whole cache line of its own,
+    /// so per-core slots like <tt>padded<variant<...>, cache_line_size></tt>
+    /// never straddle or falsely share a line.
+    /// The wrapped object is accessed via \ref value() or the implicit conversions.
+    template <typename T, std::size_t Alignment = cache_line_size>
+    class alignas(Alignment) padded
+    {
+        static_assert(Alignment >= alignof(T),
+                      "alignment must not be lower than the natural one");
+    public:
+        //=== typedefs ===//
+        using value_type = T;
+
+        //=== constructors/assignment ===//
+        /// \brief Initializes the wrapped object with the given arguments.
+        template <typename ... Args,
+                  typename = typename std::enable_if<
+                      !std::is_same<typename std::decay<
+                            typename detail::first_of<Args...>::type>::type,
+                          padded>::value>::type>
+        padded(Args&&... args)
+        : value_(std::forward<Args>(args)...) {}
+
+        /// \brief Assigns to the wrapped object.
+        template <typename U>
+        padded& operator=(U &&u)
+        {
+            value_ = std::forward<U>(u);
+            return *this;
+        }
+
+        //=== access ===//
+        /// @{
+        /// \brief Returns the wrapped object.
+        value_type& value() noexcept
+        {
+            return value_;
+        }
+
+        const value_type& value() const noexcept
+        {
+            return value_;
+        }
+
+        operator value_type&() noexcept
+        {
+            return value_;
+        }
+
+        operator const value_type&() const noexcept
+        {
+            return value_;
+        }
+        /// @}
+
+    private:
+        value_type value_;
+    };
+}} // namespace foonathan::storage
+
+#endif // FOONATHAN_STORAGE_PADDED_HPP_INCLUDED
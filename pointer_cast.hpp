@@ -5,8 +5,11 @@
 #ifndef FOONATHAN_STORAGE_POINTER_CAST_HPP_INCLUDED
 #define FOONATHAN_STORAGE_POINTER_CAST_HPP_INCLUDED
 
+#include <cstddef>
 #include <type_traits>
 
+#include "detail/config.hpp"
+
 namespace foonathan { namespace storage
 {
     namespace detail
@@ -61,6 +64,43 @@ namespace foonathan { namespace storage
     {
         return reinterpret_cast<To*>(ptr);
     }
+
+    /// \brief Converts two pointers like \ref pointer_cast
+    /// and additionally tells the compiler that the result points to a live object of the new type.
+    /// \detail Use it to access an object that was placement-newed into reused storage;
+    /// it applies \c std::launder where the standard library provides it,
+    /// so the optimizer does not have to treat the access conservatively.
+    template <typename To, typename From>
+    To* launder_cast(From *ptr) noexcept
+    {
+        return FOONATHAN_STORAGE_LAUNDER(reinterpret_cast<To*>(ptr));
+    }
+
+    /// \brief Converts a pointer into an object within a region into the offset from its base.
+    /// \detail The offset stays valid in every mapping of the region,
+    /// unlike the pointer which is only valid in the current one.
+    template <typename From>
+    std::size_t pointer_offset(const volatile void *base, From *ptr) noexcept
+    {
+        return std::size_t(reinterpret_cast<const volatile char*>(ptr)
+                         - static_cast<const volatile char*>(base));
+    }
+
+    /// @{
+    /// \brief Converts an offset from a region's base back into a pointer in the current mapping.
+    /// \note Be aware of the strict aliasing rule!
+    template <typename To>
+    To* offset_pointer(void *base, std::size_t offset) noexcept
+    {
+        return pointer_cast<To>(static_cast<char*>(base) + offset);
+    }
+
+    template <typename To>
+    const To* offset_pointer(const void *base, std::size_t offset) noexcept
+    {
+        return pointer_cast<const To>(static_cast<const char*>(base) + offset);
+    }
+    /// @}
 }} // namespace foonathan::storage
 
 #endif // FOONATHAN_RAW_STORAGE_POINTER_CAST_HPP_INCLUDED
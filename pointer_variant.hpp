@@ -0,0 +1,229 @@
+// Copyright (C) 2014 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_STORAGE_POINTER_VARIANT_HPP_INCLUDED
+#define FOONATHAN_STORAGE_POINTER_VARIANT_HPP_INCLUDED
+
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
+
+#include "variant.hpp"
+
+namespace foonathan { namespace storage
+{
+    namespace detail
+    {
+        // number of bits needed to represent the values 0 to max
+        constexpr std::size_t bits_for(std::size_t max) noexcept
+        {
+            return max == 0u ? 0u : 1u + bits_for(max / 2u);
+        }
+    } // namespace detail
+
+    /// \brief A \ref variant for type lists consisting only of pointers.
+    /// \detail It packs the discriminant into the low alignment bits of a single pointer-sized word,
+    /// so the whole variant fits into one machine word and can be used with atomics.<br>
+    /// The types specified are the pointee types, the variant stores pointers to them.
+    /// \note Every pointee type must be aligned strictly enough
+    /// to leave room for the discriminant in the low bits of its pointers.
+    template <typename ... Types>
+    class pointer_variant
+    {
+        static constexpr std::size_t tag_bits = detail::bits_for(sizeof...(Types));
+        static constexpr std::uintptr_t tag_mask = (std::uintptr_t(1) << tag_bits) - 1;
+        static_assert(detail::valid_types<Types...>(), "can't store references");
+
+        template <typename ... Ts>
+        using all_aligned = detail::variant_types<detail::select_type<(alignof(Ts) >= (1u << tag_bits))>...>;
+        static_assert(std::is_same<all_aligned<Types...>, detail::all_true_types<Types...>>::value,
+                      "pointee types are not aligned enough to hold the discriminant");
+    public:
+        //=== statics ===//
+        /// \brief Represents an invalid index of a type.
+        static constexpr auto invalid_index = sizeof...(Types);
+
+        /// \brief The pointee types.
+        using types = variant_types<Types...>;
+
+        //=== constructors/assignment ===//
+        /// @{
+        /// \brief Creates a null variant.
+        constexpr pointer_variant() noexcept
+        : ptr_(0u) {}
+
+        constexpr pointer_variant(nullvar_t) noexcept
+        : pointer_variant() {}
+        /// @}
+
+        /// \brief Initializes it with a pointer.
+        /// \note The pointee type must be one of the types specified.
+        template <typename T>
+        pointer_variant(T *ptr) noexcept
+        : ptr_(make_word(ptr, detail::get_index<T, Types...>()))
+        {
+            static_assert(detail::get_index<T, Types...>() != invalid_index,
+                          "type is not one of the types specified");
+        }
+
+        /// \brief Assigns a null state.
+        pointer_variant& operator=(nullvar_t) noexcept
+        {
+            ptr_ = 0u;
+            return *this;
+        }
+
+        /// \brief Assigns a new pointer.
+        /// \note The pointee type must be one of the types specified.
+        template <typename T>
+        pointer_variant& operator=(T *ptr) noexcept
+        {
+            *this = pointer_variant(ptr);
+            return *this;
+        }
+
+        /// \brief Swaps two variants, this is just a swap of the words.
+        friend void swap(pointer_variant &a, pointer_variant &b) noexcept
+        {
+            auto tmp = a.ptr_;
+            a.ptr_ = b.ptr_;
+            b.ptr_ = tmp;
+        }
+
+        //=== accessors ===//
+        /// \brief Returns \c true if there is a pointer currently stored inside the variant.
+        explicit operator bool() const noexcept
+        {
+            return ptr_ != 0u;
+        }
+
+        /// \brief Returns the index of the pointee type currently stored inside the variant.
+        /// \detail If the variant is null, it returns \ref invalid_index.
+        std::size_t which() const noexcept
+        {
+            return ptr_ == 0u ? invalid_index : std::size_t(ptr_ & tag_mask) - 1u;
+        }
+
+        //=== comparision ===//
+        /// @{
+        /// \brief Compares two variants for (in-)equality, i.e. same type and same pointer.
+        friend bool operator==(const pointer_variant &a, const pointer_variant &b) noexcept
+        {
+            return a.ptr_ == b.ptr_;
+        }
+
+        friend bool operator!=(const pointer_variant &a, const pointer_variant &b) noexcept
+        {
+            return !(a == b);
+        }
+        /// @}
+
+        /// @{
+        /// \brief Compares a variant and \ref nullvar_t.
+        friend bool operator==(const pointer_variant &a, nullvar_t) noexcept
+        {
+            return !a;
+        }
+
+        friend bool operator==(nullvar_t, const pointer_variant &b) noexcept
+        {
+            return !b;
+        }
+
+        friend bool operator!=(const pointer_variant &a, nullvar_t) noexcept
+        {
+            return static_cast<bool>(a);
+        }
+
+        friend bool operator!=(nullvar_t, const pointer_variant &b) noexcept
+        {
+            return static_cast<bool>(b);
+        }
+        /// @}
+
+    private:
+        template <typename T>
+        static std::uintptr_t make_word(T *ptr, std::size_t index) noexcept
+        {
+            auto word = reinterpret_cast<std::uintptr_t>(ptr);
+            assert((word & tag_mask) == 0u && "pointer is not aligned enough");
+            return word | std::uintptr_t(index + 1u);
+        }
+
+        void* pointer() const noexcept
+        {
+            return reinterpret_cast<void*>(ptr_ & ~tag_mask);
+        }
+
+        std::uintptr_t ptr_;
+
+        template <typename T, typename ... UTypes>
+        friend T* get(const pointer_variant<UTypes...> &var) noexcept;
+    };
+
+    /// \brief Whether or not a \ref pointer_variant currently contains a pointer to a specific type.
+    /// \relates pointer_variant
+    template <typename T, typename ... Types>
+    bool contains(const pointer_variant<Types...> &var) noexcept
+    {
+        return var && var.which() == detail::get_index<T, Types...>();
+    }
+
+    /// @{
+    /// \brief Returns the pointer currently stored.
+    /// \detail You have to specify the pointee type explicitly and it must be currently stored.
+    /// \relates pointer_variant
+    template <typename T, typename ... Types>
+    T* get(const pointer_variant<Types...> &var) noexcept
+    {
+        constexpr auto index = detail::get_index<T, Types...>();
+        static_assert(index != pointer_variant<Types...>::invalid_index,
+                      "type is not one of the types specified");
+        assert(var.which() == index && "type not currently stored inside the variant");
+        return static_cast<T*>(var.pointer());
+    }
+
+    // also needed for non-const variants,
+    // the unconstrained raw storage get would be a better match otherwise
+    template <typename T, typename ... Types>
+    T* get(pointer_variant<Types...> &var) noexcept
+    {
+        const pointer_variant<Types...> &cvar = var;
+        return get<T>(cvar);
+    }
+    /// @}
+
+    /// \brief Visits a \ref pointer_variant.
+    /// \detail The visitor is called with the stored pointer, i.e. a \c T* for each pointee type.
+    /// It reuses the \ref variant visitation machinery including the value returning mode.
+    /// \relates pointer_variant
+    template <class Visitor, typename ... Types>
+    auto visit(const pointer_variant<Types...> &var, Visitor &&visitor)
+    -> detail::visit_result<Visitor&&, const pointer_variant<Types...>&, Types...>
+    {
+        return detail::variant_visit(variant_types<Types...>(),
+                                     std::forward<Visitor>(visitor), var);
+    }
+}} // namespace foonathan::storage
+
+namespace std
+{
+    /// \brief Specialization of \c std::hash for \ref pointer_variant.
+    template <typename ... Types>
+    class hash<foonathan::storage::pointer_variant<Types...>>
+    {
+    public:
+        using argument_type = foonathan::storage::pointer_variant<Types...>;
+        using result_type = size_t;
+
+        result_type operator()(const argument_type &arg) const noexcept
+        {
+            if (!arg)
+                return static_cast<result_type>(19937); // magic value
+            return visit(arg, foonathan::storage::detail::variant_hash_visitor());
+        }
+    };
+} // namespace std
+
+#endif // FOONATHAN_STORAGE_POINTER_VARIANT_HPP_INCLUDED
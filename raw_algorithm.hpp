@@ -0,0 +1,159 @@
+// Copyright (C) 2014 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_STORAGE_RAW_ALGORITHM_HPP_INCLUDED
+#define FOONATHAN_STORAGE_RAW_ALGORITHM_HPP_INCLUDED
+
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+#include "raw_storage.hpp"
+
+namespace foonathan { namespace storage
+{
+    namespace detail
+    {
+        // make the raw storage overload visible here as well;
+        // the forward declared variant overloads in variant_helper.hpp would hide it
+        // and argument dependent lookup cannot find it
+        // since the aligned union lives in namespace std
+        using foonathan::storage::get;
+
+        // enables an algorithm for buffers of a suitable storage type,
+        // same constraints as the single-object emplace
+        template <typename T, typename Storage, typename Result = void>
+        using enable_storage_for = typename
+            std::enable_if<std::is_pod<Storage>::value
+                        && sizeof(T) <= sizeof(Storage)
+                        && alignof(T) <= alignof(Storage), Result>::type;
+
+        //=== destroy_n ===//
+        template <typename T, typename Storage>
+        void destroy_n(std::true_type, Storage *, std::size_t) noexcept
+        {
+            // trivially destructible, nothing to do
+        }
+
+        template <typename T, typename Storage>
+        void destroy_n(std::false_type, Storage *buffer, std::size_t n) noexcept
+        {
+            for (std::size_t i = 0u; i != n; ++i)
+                get<T>(buffer[i])->~T();
+        }
+
+        //=== uninitialized_fill ===//
+        template <typename T, typename Storage>
+        void uninitialized_fill(std::true_type, Storage *dst, std::size_t n, const T &value)
+        {
+            // trivially copyable, construction cannot throw;
+            // a plain loop the compiler can turn into memset/vectorized stores
+            for (std::size_t i = 0u; i != n; ++i)
+                std::memcpy(&dst[i], &value, sizeof(T));
+        }
+
+        template <typename T, typename Storage>
+        void uninitialized_fill(std::false_type, Storage *dst, std::size_t n, const T &value)
+        {
+            std::size_t i = 0u;
+            try
+            {
+                for (; i != n; ++i)
+                    emplace<T>(dst[i], value);
+            }
+            catch (...)
+            {
+                // roll back the already constructed objects
+                destroy_n<T>(std::false_type(), dst, i);
+                throw;
+            }
+        }
+
+        //=== uninitialized_move_n ===//
+        template <typename T, typename Storage>
+        void uninitialized_move_n(std::true_type, Storage *src, std::size_t n, Storage *dst) noexcept
+        {
+            std::memcpy(dst, src, n * sizeof(Storage));
+        }
+
+        template <typename T, typename Storage>
+        void uninitialized_move_n(std::false_type, Storage *src, std::size_t n, Storage *dst)
+        {
+            std::size_t i = 0u;
+            try
+            {
+                for (; i != n; ++i)
+                    emplace<T>(dst[i], std::move(*get<T>(src[i])));
+            }
+            catch (...)
+            {
+                destroy_n<T>(std::false_type(), dst, i);
+                throw;
+            }
+        }
+
+        //=== relocate ===//
+        template <typename T, typename Storage>
+        void relocate(std::true_type, Storage *src, std::size_t n, Storage *dst) noexcept
+        {
+            // trivially relocatable, move the bytes and forget the sources
+            uninitialized_move_n<T>(std::true_type(), src, n, dst);
+        }
+
+        template <typename T, typename Storage>
+        void relocate(std::false_type, Storage *src, std::size_t n, Storage *dst)
+        {
+            uninitialized_move_n<T>(std::false_type(), src, n, dst);
+            destroy_n<T>(std::is_trivially_destructible<T>(), src, n);
+        }
+    } // namespace detail
+
+    /// \brief Destroys the first \c n objects of type \c T stored in a buffer of \ref storage.
+    /// \detail For trivially destructible types this compiles away entirely.
+    template <typename T, typename Storage>
+    auto destroy_n(Storage *buffer, std::size_t n) noexcept
+    -> detail::enable_storage_for<T, Storage>
+    {
+        detail::destroy_n<T>(std::is_trivially_destructible<T>(), buffer, n);
+    }
+
+    /// \brief Constructs \c n copies of a value in consecutive \ref storage slots.
+    /// \detail Trivially copyable types take a loop of byte copies the compiler
+    /// can turn into memset/vectorized stores; otherwise objects are
+    /// copy-constructed one by one and already constructed ones are destroyed again
+    /// if a constructor throws.
+    template <typename T, typename Storage>
+    auto uninitialized_fill(Storage *dst, std::size_t n, const T &value)
+    -> detail::enable_storage_for<T, Storage>
+    {
+        detail::uninitialized_fill(std::is_trivially_copyable<T>(), dst, n, value);
+    }
+
+    /// \brief Move-constructs the first \c n objects of one \ref storage buffer into another.
+    /// \detail The source objects stay alive (in the moved-from state);
+    /// call \ref destroy_n() afterwards or use \ref uninitialized_relocate().
+    /// Trivially copyable types are copied with a single \c memcpy.
+    /// If a move constructor throws, the already constructed objects are destroyed again.
+    template <typename T, typename Storage>
+    auto uninitialized_move_n(Storage *src, std::size_t n, Storage *dst)
+    -> detail::enable_storage_for<T, Storage>
+    {
+        detail::uninitialized_move_n<T>(std::is_trivially_copyable<T>(), src, n, dst);
+    }
+
+    /// \brief Relocates the first \c n objects of one \ref storage buffer into another,
+    /// i.e. moves them and destroys the sources.
+    /// \detail \ref is_trivially_relocatable types are relocated with a single \c memcpy
+    /// and no destructor calls at all.
+    /// If a move constructor throws, the already constructed targets are destroyed,
+    /// while the sources all stay alive.
+    template <typename T, typename Storage>
+    auto uninitialized_relocate(Storage *src, std::size_t n, Storage *dst)
+    -> detail::enable_storage_for<T, Storage>
+    {
+        detail::relocate<T>(is_trivially_relocatable<T>(), src, n, dst);
+    }
+}} // namespace foonathan::storage
+
+#endif // FOONATHAN_STORAGE_RAW_ALGORITHM_HPP_INCLUDED
@@ -5,6 +5,7 @@
 #ifndef FOONATHAN_STORAGE_RAW_STORAGE_HPP_INCLUDED
 #define FOONATHAN_STORAGE_RAW_STORAGE_HPP_INCLUDED
 
+#include <cstddef>
 #include <new>
 #include <type_traits>
 
@@ -19,6 +20,25 @@ namespace foonathan { namespace storage
     template <typename ... Types>
     using storage = detail::aligned_union_t<Types...>;
 
+    /// \brief A \ref storage whose alignment can be raised above the natural one,
+    /// e.g. to a cache line for SIMD payloads or per-core slots.
+    /// \detail The size is padded to a multiple of the alignment,
+    /// so consecutive instances never share an alignment boundary.
+    /// \ref emplace() and \ref get() work on it unchanged.
+    template <std::size_t Alignment, typename ... Types>
+    using aligned_storage_for = typename detail::over_aligned_union<Alignment, Types...>::type;
+
+    /// \brief Whether a type can be relocated by copying its bytes.
+    /// \detail Relocation is a move construction at a new location
+    /// combined with the destruction of the old object.
+    /// For most types this is equivalent to a bitwise copy of the bytes -
+    /// all trivially copyable types qualify automatically,
+    /// other types (e.g. containers that don't point into themselves)
+    /// can opt in by specializing this trait.
+    template <typename T>
+    struct is_trivially_relocatable
+    : std::integral_constant<bool, std::is_trivially_copyable<T>::value> {};
+
     /// \brief Emplaces an object inside a \ref storage and returns a pointer to it.
     template <typename T, typename Storage, typename ... Args>
     auto emplace(Storage &s, Args&&... args)
@@ -31,16 +51,19 @@ namespace foonathan { namespace storage
 
     /// @{
     /// \brief Returns a pointer to the object stored inside a \ref storage.
+    /// \detail The pointer is laundered and carries the alignment guarantee of the storage itself,
+    /// which is at least the maximum alignment of all its types -
+    /// this lets the compiler vectorize loops reading through it.
     template <typename T, typename Storage>
     T* get(Storage &s) noexcept
     {
-        return pointer_cast<T>(&s);
+        return FOONATHAN_STORAGE_ASSUME_ALIGNED(launder_cast<T>(&s), alignof(Storage));
     }
 
     template <typename T, typename Storage>
     const T* get(const Storage &s) noexcept
     {
-        return pointer_cast<const T>(&s);
+        return FOONATHAN_STORAGE_ASSUME_ALIGNED(launder_cast<const T>(&s), alignof(Storage));
     }
     /// @}
 }} // namespace foonathan::storage
@@ -5,9 +5,27 @@
 #ifndef FOONATHAN_STORAGE_HPP_INCLUDED
 #define FOONATHAN_STORAGE_HPP_INCLUDED
 
+#include "atomic_optional.hpp"
+#include "boxed.hpp"
+#include "buffered_variant.hpp"
+#include "compact_optional.hpp"
+#include "constexpr_optional.hpp"
+#include "constexpr_variant.hpp"
+#include "expected.hpp"
+#include "inplace_function.hpp"
+#include "inplace_vector.hpp"
+#include "lazy.hpp"
+#include "nonnull_variant.hpp"
+#include "offset_ptr.hpp"
 #include "optional.hpp"
+#include "optional_vector.hpp"
+#include "padded.hpp"
 #include "pointer_cast.hpp"
+#include "pointer_variant.hpp"
+#include "raw_algorithm.hpp"
 #include "raw_storage.hpp"
 #include "variant.hpp"
+#include "variant_vector.hpp"
+#include "wire_format.hpp"
 
 #endif // FOONATHAN_STORAGE_HPP_INCLUDED
\ No newline at end of file
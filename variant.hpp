@@ -8,6 +8,7 @@
 #include <cassert>
 #include <type_traits>
 
+#include "detail/config.hpp"
 #include "detail/variant_helper.hpp"
 #include "raw_storage.hpp"
 
@@ -30,7 +31,9 @@ namespace foonathan { namespace storage
     {
         static_assert(detail::valid_types<Types...>(), "can't store references");
         using trivial = std::integral_constant<bool, detail::trivial_types<Types...>()>;
+        using relocatable = std::integral_constant<bool, detail::relocatable_types<Types...>()>;
         using nothrow_move = std::integral_constant<bool, detail::nothrow_move_types<Types...>()>;
+        using which_type = detail::compact_index_t<sizeof...(Types)>;
     public:
         //=== statics ===//
         /// \brief Represents an invalid index of a type.
@@ -60,7 +63,7 @@ namespace foonathan { namespace storage
             static_assert(index != invalid_index,
                           "type is not one of the types specified");
             emplace<t>(storage_, std::forward<T>(val));
-            which_ = index;
+            which_ = which_type(index);
         }
 
         /// \brief Copy-constructs a variant by copying the currently stored type.
@@ -70,11 +73,13 @@ namespace foonathan { namespace storage
         }
 
         /// \brief Move-constructs a variant by moving the currently stored type.
-        /// \detail The other variant still contains a value of that type after the operation,
+        /// \detail If all types are trivially relocatable (see \ref is_trivially_relocatable),
+        /// the value is relocated by copying its bytes and the other variant is null afterwards.
+        /// Otherwise the other variant still contains a value of that type after the operation,
         /// but a value that has been moved out.
-        variant(variant &&other) noexcept(nothrow_move::value)
+        variant(variant &&other) noexcept(relocatable::value || nothrow_move::value)
         {
-            construct(trivial(), std::move(other));
+            construct_move(relocatable(), std::move(other));
         }
 
         /// \brief Destroys the currently stored value - if any.
@@ -95,11 +100,17 @@ namespace foonathan { namespace storage
         }
 
         /// \brief Move-assigns another variant by moving the currently stored value.
-        /// \detail It just calls \ref emplace() passing the currently stored type.
-        variant& operator=(variant &&other) noexcept(nothrow_move::value)
+        /// \detail For trivially relocatable types the value is relocated as in the move constructor,
+        /// otherwise it just calls \ref emplace() passing the currently stored type.
+        variant& operator=(variant &&other) noexcept(relocatable::value || nothrow_move::value)
         {
             if (trivial::value)
                 construct(std::true_type(), std::move(other));
+            else if (relocatable::value)
+            {
+                *this = nullvar;
+                construct_move(std::true_type(), std::move(other));
+            }
             else
                 visit(std::move(other), detail::variant_emplace_visitor(*this));
             return *this;
@@ -110,7 +121,7 @@ namespace foonathan { namespace storage
         {
             if (!trivial::value && *this)
                 visit(*this, detail::variant_destroy_visitor());
-            which_ = invalid_index;
+            which_ = which_type(invalid_index);
             return *this;
         }
 
@@ -126,14 +137,22 @@ namespace foonathan { namespace storage
         }
 
         /// \brief Swaps two variants.
-        /// \details If both variants contain the same types, the swap from the type is called.
+        /// \details If all types are trivially relocatable, the raw bytes are swapped directly,
+        /// no matter which types are stored.<br>
+        /// Otherwise: if both variants contain the same types, the swap from the type is called.
         /// If only one  of them contains an object, this object is moved over and at the old position destroyed.
-        /// If both contains an object but of different types, the variant is swapped via \c std::swap on the variants.
+        /// If both contains an object but of different types,
+        /// the first payload is parked in a single raw temporary,
+        /// for three moves in total - the first payload twice, the second once -
+        /// instead of the nine a \c std::swap over whole variants would do.
         /// \note In the last case, a throwing move constructor only allows the basic exception safety.
-        friend void swap(variant &a, variant &b) noexcept(nothrow_move::value)
+        friend void swap(variant &a, variant &b) noexcept(relocatable::value || nothrow_move::value)
         {
-            if (trivial::value)
+            if (relocatable::value)
             {
+                // relocation is a bitwise copy,
+                // so simply swap the bytes of storage and discriminant,
+                // this also handles variants storing different types
                 std::swap(a.storage_, b.storage_);
                 std::swap(a.which_, b.which_);
             }
@@ -144,16 +163,16 @@ namespace foonathan { namespace storage
                     if (a.which() == b.which())
                         visit(b, detail::variant_swap_visitor(a));
                     else
-                        std::swap(a, b);
+                        visit(a, detail::variant_cross_swap_visitor<variant>(a, b));
                 }
                 else if (a && !b)
                 {
-                     b.construct(std::move(a));
+                     b.construct_move(relocatable(), std::move(a));
                      a = nullvar;
                 }
                 else if (b && !a)
                 {
-                    a.construct(std::move(b));
+                    a.construct_move(relocatable(), std::move(b));
                     b = nullvar;
                 }
             }
@@ -182,11 +201,7 @@ namespace foonathan { namespace storage
             if (!a && !b)
                 return true;
             if (a.which() == b.which())
-            {
-                detail::variant_compare_visitor<variant> visitor(a);
-                visit(b, visitor);
-                return visitor.equal;
-            }
+                return visit(b, detail::variant_compare_visitor<variant>(a));
             return false;
         }
 
@@ -272,6 +287,22 @@ namespace foonathan { namespace storage
             }
         }
 
+        // relocatable types: move the bytes over and null the other variant,
+        // ownership of the stored value is transferred
+        void construct_move(std::true_type, variant &&other) noexcept
+        {
+            storage_ = other.storage_;
+            which_ = other.which_;
+            if (!trivial::value)
+                other.which_ = which_type(invalid_index);
+        }
+
+        // not relocatable, move-construct the stored value
+        void construct_move(std::false_type, variant &&other)
+        {
+            construct(trivial(), std::move(other));
+        }
+
         // single argument that can be assigned
         template <typename T, typename U>
         void assign(U &&u,
@@ -290,6 +321,23 @@ namespace foonathan { namespace storage
         // create temporary and move in because constructor can throw and move does not
         template <typename T, typename ... Args>
         void emplace_impl(std::true_type, Args&&... args)
+        {
+            emplace_relocate<T>(relocatable(), std::forward<Args>(args)...);
+        }
+
+        // relocatable: construct into a temporary raw storage and move the bytes over,
+        // saving the move construction and second destructor call of the temporary
+        template <typename T, typename ... Args>
+        void emplace_relocate(std::true_type, Args&&... args)
+        {
+            storage<Types...> tmp;
+            emplace<T>(tmp, std::forward<Args>(args)...);
+            *this = nullvar;
+            storage_ = tmp; // ownership of the value is transferred
+        }
+
+        template <typename T, typename ... Args>
+        void emplace_relocate(std::false_type, Args&&... args)
         {
             T tmp(std::forward<Args>(args)...);
             *this = nullvar;
@@ -304,13 +352,23 @@ namespace foonathan { namespace storage
             emplace<T>(storage_, std::forward<Args>(args)...);
         }
 
+        // the discriminant uses the smallest possible integer type,
+        // so it can hide in the padding of the aligned union
         storage<Types...> storage_;
-        std::size_t which_;
+        which_type which_;
 
         template <typename T, typename ... UTypes, typename ... Args>
         friend void emplace(variant<UTypes...> &var, Args&&... args);
         template <typename T, typename ... UTypes>
         friend const T& get(const variant<UTypes...> &var);
+        template <typename T, typename ... UTypes>
+        friend const T& get_unchecked(const variant<UTypes...> &var) noexcept;
+        template <typename T, typename ... UTypes>
+        friend T take(variant<UTypes...> &&var);
+        template <class Variant>
+        friend struct detail::variant_cross_swap_visitor;
+        template <class Variant>
+        friend struct detail::variant_cross_swap_inner;
     };
 
     /// @{
@@ -363,18 +421,29 @@ namespace foonathan { namespace storage
         static_assert(index != variant<Types...>::invalid_index,
                      "type is not one of the types specified");
         if (variant<Types...>::trivial::value || !var)
+        {
             // just create new one, nothing to destroy
+            FOONATHAN_STORAGE_COUNT_OPERATION(t, emplace_construct);
             emplace<t>(var.storage_, std::forward<Args>(args)...);
+        }
         else if (index == var.which_)
+        {
             // assign new value
+            FOONATHAN_STORAGE_COUNT_OPERATION(t, emplace_assign);
             var.template assign<t>(std::forward<Args>(args)...);
+        }
         else
-            // destroy and create new
+        {
+            // destroy and create new, over a temporary if the constructor can throw
+            // and either relocation or a nothrow move can transfer it safely
+            FOONATHAN_STORAGE_COUNT_OPERATION(t, emplace_temporary);
             var.template emplace_impl<t>(std::integral_constant<bool,
                                          !noexcept(T(std::forward<Args>(args)...))
-                                         && std::is_nothrow_move_constructible<T>::value>{},
+                                         && (variant<Types...>::relocatable::value
+                                             || std::is_nothrow_move_constructible<T>::value)>{},
                                          std::forward<Args>(args)...);
-        var.which_ = index;
+        }
+        var.which_ = typename variant<Types...>::which_type(index);
     }
 
     /// @{
@@ -403,6 +472,54 @@ namespace foonathan { namespace storage
     }
     /// @}
 
+    /// @{
+    /// \brief Returns a reference to the object currently stored without any checking.
+    /// \detail Unlike \ref get(), this never asserts,
+    /// even in builds where assertions are otherwise enabled.
+    /// The behavior is undefined if the type is not currently stored.
+    /// \relates variant
+    template <typename T, typename ... Types>
+    const T& get_unchecked(const variant<Types...> &var) noexcept
+    {
+        return *get<T>(var.storage_);
+    }
+
+    template <typename T, typename ... Types>
+    T& get_unchecked(variant<Types...> &var) noexcept
+    {
+        const variant<Types...> &cvar = var;
+        return const_cast<T&>(get_unchecked<T>(cvar));
+    }
+
+    template <typename T, typename ... Types>
+    T&& get_unchecked(variant<Types...> &&var) noexcept
+    {
+        return std::move(get_unchecked<T>(var));
+    }
+    /// @}
+
+    /// @{
+    /// \brief Returns a pointer to the stored object of the given type - or \c nullptr.
+    /// \detail Unlike \ref try_get(), this involves neither copies nor assertions,
+    /// making it suitable for probing a variant on hot paths.
+    /// \relates variant
+    template <typename T, typename ... Types>
+    const T* get_if(const variant<Types...> *var) noexcept
+    {
+        if (var && contains<T>(*var))
+            return &get_unchecked<T>(*var);
+        return nullptr;
+    }
+
+    template <typename T, typename ... Types>
+    T* get_if(variant<Types...> *var) noexcept
+    {
+        if (var && contains<T>(*var))
+            return &get_unchecked<T>(*var);
+        return nullptr;
+    }
+    /// @}
+
     /// @{
     /// \brief Tries to return a copy of the stored object inside a \ref variant.
     /// \detail If there is not an object of given type stored, it will return \c val.
@@ -425,38 +542,219 @@ namespace foonathan { namespace storage
     }
     /// @}
 
+    /// \brief Moves the stored value out of a \ref variant and leaves it null.
+    /// \detail Unlike \c get() on an rvalue followed by a \ref nullvar assignment,
+    /// the discriminant is nulled directly:
+    /// for trivially relocatable types the moved-from object's destructor is skipped entirely,
+    /// otherwise it runs without a visitor dispatch since the type is known statically.
+    /// \note The type must be currently stored.
+    /// \relates variant
+    template <typename T, typename ... Types>
+    T take(variant<Types...> &&var)
+    {
+        assert((contains<T>(var)) && "type not currently stored inside the variant");
+        T result(std::move(*get<T>(var.storage_)));
+        if (!is_trivially_relocatable<T>::value)
+            get<T>(var.storage_)->~T();
+        var.which_ = typename variant<Types...>::which_type(variant<Types...>::invalid_index);
+        return result;
+    }
+
+    /// \brief Tries to move the stored value of a \ref variant into \c dest.
+    /// \detail If an object of the given type is stored, it is taken out as by \ref take()
+    /// and the variant is left null, otherwise nothing happens.
+    /// \returns \c true if a value was extracted, \c false otherwise.
+    /// \relates variant
+    template <typename T, typename ... Types>
+    bool extract(variant<Types...> &var, T &dest)
+    {
+        if (!contains<T>(var))
+            return false;
+        dest = take<T>(std::move(var));
+        return true;
+    }
+
     /// @{
     /// \brief Visits a \ref variant.
     /// \detail A \c Visitor is a function object providing an \c operator() taking a type of a variant for each type.
-    /// This function selects the appropriate one based on the type currently stored in it.
+    /// This function selects the appropriate one based on the type currently stored in it
+    /// and returns its result directly.
+    /// The return type is deduced from calling the visitor with the first type,
+    /// the other overloads must return a type convertible to it.
+    /// \note If the visitor does not return \c void, the variant must not be null.
     /// \relates variant
     template <class Visitor, typename ... Types>
-    void visit(const variant<Types...> &var, Visitor &&visitor)
+    auto visit(const variant<Types...> &var, Visitor &&visitor)
+    -> detail::visit_result<Visitor&&, const variant<Types...>&, Types...>
     {
-        detail::variant_visit(variant_types<Types...>(),
-                              std::forward<Visitor>(visitor), var);
+        return detail::variant_visit(variant_types<Types...>(),
+                                     std::forward<Visitor>(visitor), var);
     }
 
     template <class Visitor, typename ... Types>
-    void visit(variant<Types...> &var, Visitor &&visitor)
+    auto visit(variant<Types...> &var, Visitor &&visitor)
+    -> detail::visit_result<Visitor&&, variant<Types...>&, Types...>
     {
-        detail::variant_visit(variant_types<Types...>(),
-                              std::forward<Visitor>(visitor), var);
+        return detail::variant_visit(variant_types<Types...>(),
+                                     std::forward<Visitor>(visitor), var);
     }
 
     template <class Visitor, typename ... Types>
-    void visit(variant<Types...> &&var, Visitor &&visitor)
+    auto visit(variant<Types...> &&var, Visitor &&visitor)
+    -> detail::visit_result<Visitor&&, variant<Types...>&&, Types...>
+    {
+        return detail::variant_visit(variant_types<Types...>(),
+                                     std::forward<Visitor>(visitor), std::move(var));
+    }
+    /// @}
+
+    /// @{
+    /// \brief Visits a \ref variant with a hint which type is most likely stored.
+    /// \detail Behaves exactly like \ref visit(),
+    /// but first tests for the given type with the branch predicted in its favor:
+    /// when the hint is right, the visitor call is inlined at the call site
+    /// instead of going through the general dispatch.
+    /// \relates variant
+    template <typename T, class Visitor, typename ... Types>
+    auto visit_likely(const variant<Types...> &var, Visitor &&visitor)
+    -> detail::visit_result<Visitor&&, const variant<Types...>&, Types...>
+    {
+        if (FOONATHAN_STORAGE_LIKELY(var.which() == get_index<T>(var)))
+            return std::forward<Visitor>(visitor)(get_unchecked<T>(var));
+        return visit(var, std::forward<Visitor>(visitor));
+    }
+
+    template <typename T, class Visitor, typename ... Types>
+    auto visit_likely(variant<Types...> &var, Visitor &&visitor)
+    -> detail::visit_result<Visitor&&, variant<Types...>&, Types...>
     {
-        detail::variant_visit(variant_types<Types...>(),
-                              std::forward<Visitor>(visitor), std::move(var));
+        if (FOONATHAN_STORAGE_LIKELY(var.which() == get_index<T>(var)))
+            return std::forward<Visitor>(visitor)(get_unchecked<T>(var));
+        return visit(var, std::forward<Visitor>(visitor));
+    }
+
+    template <typename T, class Visitor, typename ... Types>
+    auto visit_likely(variant<Types...> &&var, Visitor &&visitor)
+    -> detail::visit_result<Visitor&&, variant<Types...>&&, Types...>
+    {
+        if (FOONATHAN_STORAGE_LIKELY(var.which() == get_index<T>(var)))
+            return std::forward<Visitor>(visitor)(get_unchecked<T>(std::move(var)));
+        return visit(std::move(var), std::forward<Visitor>(visitor));
     }
     /// @}
+
+    /// @{
+    /// \brief The same as \ref get_if(), but with the branch predicted towards the type being stored.
+    /// \relates variant
+    template <typename T, typename ... Types>
+    const T* get_if_likely(const variant<Types...> *var) noexcept
+    {
+        if (FOONATHAN_STORAGE_LIKELY(var && contains<T>(*var)))
+            return &get_unchecked<T>(*var);
+        return nullptr;
+    }
+
+    template <typename T, typename ... Types>
+    T* get_if_likely(variant<Types...> *var) noexcept
+    {
+        if (FOONATHAN_STORAGE_LIKELY(var && contains<T>(*var)))
+            return &get_unchecked<T>(*var);
+        return nullptr;
+    }
+    /// @}
+
+    namespace detail
+    {
+        template <typename T>
+        struct is_variant : std::false_type {};
+
+        template <typename ... Types>
+        struct is_variant<foonathan::storage::variant<Types...>> : std::true_type {};
+
+        template <typename ... Ts>
+        constexpr bool all_variants() noexcept
+        {
+            using is_variant_types = variant_types<select_type<is_variant<Ts>::value>...>;
+            return std::is_same<is_variant_types, all_true_types<Ts...>>::value;
+        }
+    } // namespace detail
+
+    /// \brief Visits multiple \ref variant objects at once.
+    /// \detail A \c Visitor must here provide an \c operator() for each combination of types of the variants.
+    /// It computes a single flattened index from the individual \c which() values
+    /// and dispatches once through one table instead of nesting multiple \ref visit() calls.
+    /// If the visitor returns \c void and any of the variants is null, the visitor is not called at all;
+    /// otherwise no variant may be null.
+    /// \relates variant
+    template <class Visitor, class ... Variants>
+    auto visit(Visitor &&visitor, Variants&&... variants)
+    -> typename std::enable_if<!detail::is_variant<typename std::decay<Visitor>::type>::value
+                            && detail::all_variants<typename std::decay<Variants>::type...>(),
+                               detail::multi_visit_result<Visitor&&, Variants&&...>>::type
+    {
+        return detail::multi_visit(std::forward<Visitor>(visitor), std::forward<Variants>(variants)...);
+    }
+
+    /// \brief A hash function object for \ref variant that also accepts the alternatives directly.
+    /// \detail For a variant it mixes \ref variant::which() into the hash of the stored value,
+    /// for a value of one of the types it computes the hash the variant storing that value would have.
+    /// It is transparent, so in C++20 an \c std::unordered_map keyed on variants
+    /// can be probed with a bare value without materializing a temporary variant.
+    /// \relates variant
+    template <typename ... Types>
+    struct variant_hash
+    {
+        using is_transparent = void;
+
+        std::size_t operator()(const variant<Types...> &var) const noexcept
+        {
+            if (!var)
+                return static_cast<std::size_t>(19937); // magic value
+            return detail::hash_mix(var.which(), visit(var, detail::variant_hash_visitor()));
+        }
+
+        template <typename T>
+        std::size_t operator()(const T &value) const noexcept
+        {
+            constexpr auto index = detail::get_index<T, Types...>();
+            static_assert(index != variant<Types...>::invalid_index,
+                          "type is not one of the types specified");
+            return detail::hash_mix(index, std::hash<T>()(value));
+        }
+    };
+
+    /// \brief A transparent equality function object for \ref variant.
+    /// \detail It compares through the heterogeneous \c operator== of \ref variant,
+    /// so lookups with a bare value compare in place instead of constructing a variant key.
+    /// \relates variant
+    template <typename ... Types>
+    struct variant_equal
+    {
+        using is_transparent = void;
+
+        bool operator()(const variant<Types...> &a, const variant<Types...> &b) const
+        {
+            return a == b;
+        }
+
+        template <typename T>
+        bool operator()(const variant<Types...> &a, const T &b) const
+        {
+            return a == b;
+        }
+
+        template <typename T>
+        bool operator()(const T &a, const variant<Types...> &b) const
+        {
+            return a == b;
+        }
+    };
 }} // namespace foonathan::storage
 
 namespace std
 {
     /// \brief Specialization of \c std::hash for \ref variant.
-    /// \detail It calls the hash function for the underlying type if any is currently stored,
+    /// \detail It mixes the index of the stored type into the hash of the value if any is currently stored,
     /// otherwise it will return a special value.
     template <typename ... Types>
     class hash<foonathan::storage::variant<Types...>>
@@ -467,11 +765,7 @@ namespace std
 
         result_type operator()(const argument_type &arg) const noexcept
         {
-            if (!arg)
-                return static_cast<result_type>(19937); // magic value
-            foonathan::storage::detail::variant_hash_visitor hasher;
-            visit(arg, hasher);
-            return hasher.hash;
+            return foonathan::storage::variant_hash<Types...>()(arg);
         }
     };
 } // namespace std
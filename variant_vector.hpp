@@ -0,0 +1,199 @@
+// Copyright (C) 2014 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_STORAGE_VARIANT_VECTOR_HPP_INCLUDED
+#define FOONATHAN_STORAGE_VARIANT_VECTOR_HPP_INCLUDED
+
+#include <cassert>
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+#include "detail/variant_helper.hpp"
+
+namespace foonathan { namespace storage
+{
+    /// \brief A sequence of variant values stored per-type instead of per-element.
+    /// \detail A \c std::vector of \ref variant pads every element to the size of the
+    /// largest alternative and visiting it dispatches on every single element.
+    /// This container keeps each alternative in its own contiguous typed segment
+    /// plus a compact per-element index, so \ref visit_all() can iterate one type
+    /// at a time - densely packed and without per-element dispatch.<br>
+    /// The price is that element order is only preserved per type,
+    /// not across types, and that elements cannot change their type in place.
+    template <typename ... Types>
+    class variant_vector
+    {
+        static_assert(detail::valid_types<Types...>(), "can't store references");
+        using which_type = detail::compact_index_t<sizeof...(Types)>;
+    public:
+        //=== statics ===//
+        /// \brief Represents an invalid index of a type.
+        static constexpr auto invalid_index = sizeof...(Types);
+
+        /// \brief The types.
+        using types = detail::variant_types<Types...>;
+
+        //=== modifiers ===//
+        /// \brief Appends a value to the segment of its type.
+        /// \note The type must be one of the types specified.
+        template <typename T>
+        void push_back(T &&val)
+        {
+            using t = typename std::decay<T>::type;
+            emplace_back<t>(std::forward<T>(val));
+        }
+
+        /// \brief Constructs a value directly inside the segment of the given type.
+        /// \note The type must be one of the types specified.
+        template <typename T, typename ... Args>
+        void emplace_back(Args&&... args)
+        {
+            constexpr auto index = detail::get_index<T, Types...>();
+            static_assert(index != invalid_index,
+                          "type is not one of the types specified");
+            auto &seg = std::get<index>(segments_);
+            seg.emplace_back(std::forward<Args>(args)...);
+            elements_.push_back({which_type(index),
+                                 static_cast<std::uint32_t>(seg.size() - 1u)});
+        }
+
+        /// \brief Removes all elements.
+        void clear() noexcept
+        {
+            clear_segments(types());
+            elements_.clear();
+        }
+
+        /// \brief Reserves space for elements of one specific type.
+        template <typename T>
+        void reserve(std::size_t n)
+        {
+            std::get<detail::get_index<T, Types...>()>(segments_).reserve(n);
+        }
+
+        //=== accessors ===//
+        /// \brief Returns the total number of elements stored.
+        std::size_t size() const noexcept
+        {
+            return elements_.size();
+        }
+
+        /// \brief Returns the number of elements of one specific type.
+        template <typename T>
+        std::size_t size() const noexcept
+        {
+            return std::get<detail::get_index<T, Types...>()>(segments_).size();
+        }
+
+        /// \brief Returns \c true if there are no elements stored.
+        bool empty() const noexcept
+        {
+            return elements_.empty();
+        }
+
+        /// \brief Returns the index of the type of the element at the given position.
+        std::size_t which(std::size_t i) const noexcept
+        {
+            return elements_[i].which;
+        }
+
+        /// @{
+        /// \brief Returns a reference to the element at the given position.
+        /// \detail You have to specify the type explicitly and it must be the stored one.
+        template <typename T>
+        const T& get(std::size_t i) const
+        {
+            assert((which(i) == detail::get_index<T, Types...>())
+                && "wrong type for element");
+            return std::get<detail::get_index<T, Types...>()>(segments_)[elements_[i].offset];
+        }
+
+        template <typename T>
+        T& get(std::size_t i)
+        {
+            assert((which(i) == detail::get_index<T, Types...>())
+                && "wrong type for element");
+            return std::get<detail::get_index<T, Types...>()>(segments_)[elements_[i].offset];
+        }
+        /// @}
+
+        /// @{
+        /// \brief Returns the contiguous segment containing all elements of one type.
+        template <typename T>
+        const std::vector<T>& segment() const noexcept
+        {
+            return std::get<detail::get_index<T, Types...>()>(segments_);
+        }
+
+        template <typename T>
+        std::vector<T>& segment() noexcept
+        {
+            return std::get<detail::get_index<T, Types...>()>(segments_);
+        }
+        /// @}
+
+        //=== visiting ===//
+        /// @{
+        /// \brief Calls a visitor for every element, one type at a time.
+        /// \detail All elements of the first alternative are visited first,
+        /// then all of the second and so on - a tight, dispatch-free loop per segment.
+        /// Use it whenever the order across types does not matter.
+        template <class Visitor>
+        void visit_all(Visitor &&visitor)
+        {
+            visit_segments(types(), visitor);
+        }
+
+        template <class Visitor>
+        void visit_all(Visitor &&visitor) const
+        {
+            visit_segments(types(), visitor);
+        }
+        /// @}
+
+    private:
+        struct element_ref
+        {
+            which_type which;
+            std::uint32_t offset;
+        };
+
+        void clear_segments(detail::variant_types<>) noexcept {}
+
+        template <typename Head, typename ... Tail>
+        void clear_segments(detail::variant_types<Head, Tail...>) noexcept
+        {
+            std::get<detail::get_index<Head, Types...>()>(segments_).clear();
+            clear_segments(detail::variant_types<Tail...>());
+        }
+
+        template <class Visitor>
+        void visit_segments(detail::variant_types<>, Visitor &) {}
+
+        template <class Visitor, typename Head, typename ... Tail>
+        void visit_segments(detail::variant_types<Head, Tail...>, Visitor &visitor)
+        {
+            for (auto &elem : std::get<detail::get_index<Head, Types...>()>(segments_))
+                visitor(elem);
+            visit_segments(detail::variant_types<Tail...>(), visitor);
+        }
+
+        template <class Visitor>
+        void visit_segments(detail::variant_types<>, Visitor &) const {}
+
+        template <class Visitor, typename Head, typename ... Tail>
+        void visit_segments(detail::variant_types<Head, Tail...>, Visitor &visitor) const
+        {
+            for (auto &elem : std::get<detail::get_index<Head, Types...>()>(segments_))
+                visitor(elem);
+            visit_segments(detail::variant_types<Tail...>(), visitor);
+        }
+
+        std::tuple<std::vector<Types>...> segments_;
+        std::vector<element_ref> elements_;
+    };
+}} // namespace foonathan::storage
+
+#endif // FOONATHAN_STORAGE_VARIANT_VECTOR_HPP_INCLUDED
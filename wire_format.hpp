@@ -0,0 +1,265 @@
+// Copyright (C) 2014 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_STORAGE_WIRE_FORMAT_HPP_INCLUDED
+#define FOONATHAN_STORAGE_WIRE_FORMAT_HPP_INCLUDED
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+
+#include "optional.hpp"
+#include "variant.hpp"
+
+namespace foonathan { namespace storage
+{
+    /// @{
+    /// \brief A non-owning range of bytes used by the wire format functions.
+    struct byte_span
+    {
+        unsigned char *data;
+        std::size_t size;
+    };
+
+    struct const_byte_span
+    {
+        const unsigned char *data;
+        std::size_t size;
+
+        const_byte_span(const unsigned char *data, std::size_t size) noexcept
+        : data(data), size(size) {}
+
+        const_byte_span(byte_span span) noexcept
+        : data(span.data), size(span.size) {}
+    };
+    /// @}
+
+    namespace detail
+    {
+        // the payload size of the alternative with the given index, 0 for the null state
+        template <typename ... Types>
+        std::size_t payload_size(std::size_t index) noexcept
+        {
+            static constexpr std::size_t sizes[] = {sizeof(Types)..., 0u};
+            return sizes[index];
+        }
+
+        struct serialize_visitor
+        {
+            unsigned char *payload;
+
+            template <typename T>
+            void operator()(const T &value) noexcept
+            {
+                std::memcpy(payload, &value, sizeof(T));
+            }
+        };
+
+        // materializes the alternative with the given index from raw payload bytes
+        template <class Variant>
+        void deserialize_payload(variant_types<>, std::size_t, const unsigned char *, Variant &) noexcept {}
+
+        template <class Variant, typename Head, typename ... Tail>
+        void deserialize_payload(variant_types<Head, Tail...>, std::size_t index,
+                                 const unsigned char *payload, Variant &var)
+        {
+            if (index == Variant::invalid_index - sizeof...(Tail) - 1u)
+            {
+                storage<Head> tmp;
+                std::memcpy(&tmp, payload, sizeof(Head));
+                // qualified, the raw storage get is shadowed by the declarations above
+                emplace<Head>(var, *foonathan::storage::get<Head>(tmp));
+            }
+            else
+                deserialize_payload(variant_types<Tail...>(), index, payload, var);
+        }
+    } // namespace detail
+
+    /// \brief Returns the number of bytes the wire format needs for a \ref variant.
+    /// \detail One discriminant byte plus the payload bytes of the active alternative.
+    /// \relates variant
+    template <typename ... Types>
+    std::size_t serialized_size(const variant<Types...> &var) noexcept
+    {
+        return 1u + detail::payload_size<Types...>(var.which());
+    }
+
+    /// \brief Writes a \ref variant into a byte buffer and returns the bytes written.
+    /// \detail The wire format is one discriminant byte - the index of the active
+    /// alternative, or the number of types for the null state -
+    /// followed by the raw payload bytes of the active alternative.
+    /// \note All types must be trivially copyable and fewer than 255.
+    /// \relates variant
+    template <typename ... Types>
+    std::size_t serialize_to(const variant<Types...> &var, byte_span buffer) noexcept
+    {
+        static_assert(detail::trivial_types<Types...>(),
+                      "wire format requires trivially copyable types");
+        static_assert(sizeof...(Types) < 0xFF, "too many types for a discriminant byte");
+        assert(buffer.size >= serialized_size(var) && "buffer too small");
+
+        buffer.data[0] = static_cast<unsigned char>(var.which());
+        if (var)
+            visit(var, detail::serialize_visitor{buffer.data + 1});
+        return serialized_size(var);
+    }
+
+    /// \brief Reads a \ref variant back out of a byte buffer and returns the bytes consumed.
+    /// \detail Accepts buffers produced by \ref serialize_to(), from any machine
+    /// with the same type layout and endianness.
+    /// \relates variant
+    template <typename ... Types>
+    std::size_t deserialize(variant<Types...> &var, const_byte_span buffer)
+    {
+        static_assert(detail::trivial_types<Types...>(),
+                      "wire format requires trivially copyable types");
+        assert(buffer.size >= 1u && "buffer too small");
+
+        std::size_t index = buffer.data[0];
+        assert(index <= sizeof...(Types) && "invalid discriminant byte");
+        assert(buffer.size >= 1u + detail::payload_size<Types...>(index) && "buffer too small");
+
+        if (index == sizeof...(Types))
+            var = nullvar;
+        else
+            detail::deserialize_payload(variant_types<Types...>(), index,
+                                        buffer.data + 1, var);
+        return 1u + detail::payload_size<Types...>(index);
+    }
+
+    /// @{
+    /// \brief Writes/reads an \ref optional in the same wire format.
+    /// \detail One presence byte followed by the raw payload bytes - if present.
+    /// \relates optional
+    template <typename T>
+    std::size_t serialized_size(const optional<T> &opt) noexcept
+    {
+        return 1u + (opt ? sizeof(T) : 0u);
+    }
+
+    template <typename T>
+    std::size_t serialize_to(const optional<T> &opt, byte_span buffer) noexcept
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "wire format requires a trivially copyable type");
+        assert(buffer.size >= serialized_size(opt) && "buffer too small");
+
+        buffer.data[0] = opt ? 1u : 0u;
+        if (opt)
+            std::memcpy(buffer.data + 1, &*opt, sizeof(T));
+        return serialized_size(opt);
+    }
+
+    template <typename T>
+    std::size_t deserialize(optional<T> &opt, const_byte_span buffer)
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "wire format requires a trivially copyable type");
+        assert(buffer.size >= 1u && "buffer too small");
+
+        if (buffer.data[0])
+        {
+            assert(buffer.size >= 1u + sizeof(T) && "buffer too small");
+            storage<T> tmp;
+            std::memcpy(&tmp, buffer.data + 1, sizeof(T));
+            emplace(opt, *get<T>(tmp));
+            return 1u + sizeof(T);
+        }
+        opt = nullopt;
+        return 1u;
+    }
+    /// @}
+
+    /// \brief A non-owning view of a \ref variant in wire format.
+    /// \detail It reads straight out of a received buffer without constructing a variant;
+    /// since the payload bytes in the buffer are unaligned,
+    /// values are materialized by copy on access.
+    template <typename ... Types>
+    class variant_view
+    {
+        static_assert(detail::trivial_types<Types...>(),
+                      "wire format requires trivially copyable types");
+    public:
+        //=== statics ===//
+        /// \brief Represents an invalid index of a type.
+        static constexpr auto invalid_index = sizeof...(Types);
+
+        /// \brief The types.
+        using types = variant_types<Types...>;
+
+        //=== constructors ===//
+        /// \brief Creates a view into a buffer holding a serialized variant.
+        /// \detail The buffer must stay alive as long as the view is used.
+        explicit variant_view(const_byte_span buffer) noexcept
+        : buffer_(buffer)
+        {
+            assert(buffer.size >= 1u && "buffer too small");
+            assert(buffer.data[0] <= sizeof...(Types) && "invalid discriminant byte");
+            assert(buffer.size >= 1u + detail::payload_size<Types...>(buffer.data[0])
+                && "buffer too small");
+        }
+
+        //=== accessors ===//
+        /// \brief Returns \c true if the serialized variant was not null.
+        explicit operator bool() const noexcept
+        {
+            return buffer_.data[0] != sizeof...(Types);
+        }
+
+        /// \brief Returns the index of the serialized type.
+        /// \detail If the serialized variant was null, it returns \ref invalid_index.
+        std::size_t which() const noexcept
+        {
+            return buffer_.data[0];
+        }
+
+        /// \brief Returns a copy of the serialized value.
+        /// \detail You have to specify the type explicitly and it must be the serialized one.
+        template <typename T>
+        T value() const
+        {
+            assert((which() == detail::get_index<T, Types...>())
+                && "type not serialized in the buffer");
+            storage<T> tmp;
+            std::memcpy(&tmp, buffer_.data + 1, sizeof(T));
+            return *get<T>(tmp);
+        }
+
+        /// \brief Returns the bytes the serialized variant occupies in the buffer.
+        std::size_t serialized_size() const noexcept
+        {
+            return 1u + detail::payload_size<Types...>(which());
+        }
+
+    private:
+        const_byte_span buffer_;
+    };
+
+    namespace detail
+    {
+        template <class View, class Visitor>
+        void visit_view(variant_types<>, const View &, Visitor &&) noexcept {}
+
+        template <class View, class Visitor, typename Head, typename ... Tail>
+        void visit_view(variant_types<Head, Tail...>, const View &view, Visitor &&visitor)
+        {
+            if (view.which() == View::invalid_index - sizeof...(Tail) - 1u)
+                std::forward<Visitor>(visitor)(view.template value<Head>());
+            else
+                visit_view(variant_types<Tail...>(), view, std::forward<Visitor>(visitor));
+        }
+    } // namespace detail
+
+    /// \brief Visits a \ref variant_view like a \ref variant.
+    /// \detail The visitor is called with a copy of the serialized value - if any.
+    /// \relates variant_view
+    template <class Visitor, typename ... Types>
+    void visit(const variant_view<Types...> &view, Visitor &&visitor)
+    {
+        detail::visit_view(variant_types<Types...>(), view,
+                           std::forward<Visitor>(visitor));
+    }
+}} // namespace foonathan::storage
+
+#endif // FOONATHAN_STORAGE_WIRE_FORMAT_HPP_INCLUDED